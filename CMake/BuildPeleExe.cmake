@@ -31,8 +31,12 @@ function(build_pele_exe pele_exe_name pele_physics_lib_name)
   target_sources(${pele_exe_name}
      PRIVATE
        ${SRC_DIR}/Advance.cpp
+       ${SRC_DIR}/AsyncWriter.H
+       ${SRC_DIR}/AsyncWriter.cpp
        ${SRC_DIR}/BCfill.cpp
        ${SRC_DIR}/Bld.cpp
+       ${SRC_DIR}/ChemCache.H
+       ${SRC_DIR}/ChemCache.cpp
        ${SRC_DIR}/Constants.H
        ${SRC_DIR}/Derive.H
        ${SRC_DIR}/Derive.cpp
@@ -78,6 +82,8 @@ function(build_pele_exe pele_exe_name pele_physics_lib_name)
        ${SRC_DIR}/Tagging.cpp
        ${SRC_DIR}/Timestep.H
        ${SRC_DIR}/TransCoeff.H
+       ${SRC_DIR}/TransportTable.H
+       ${SRC_DIR}/TransportTable.cpp
        ${SRC_DIR}/Utilities.H
        ${SRC_DIR}/Utilities.cpp
        ${SRC_DIR}/WENO.H
@@ -0,0 +1,374 @@
+/** \file chem-throughput.cpp
+ *  Standalone chemistry throughput benchmark
+ *
+ *  Integrates a synthetic population of thermochemical states, sampled from
+ *  a 1D premixed flame (PMF) table or from a plotfile, with the same reactor
+ *  interface used in PeleC::react_state, over a range of box sizes (cells
+ *  per reactor call on 3D boxes) and batch sizes (cells per reactor call on
+ *  1D boxes), and reports the throughput of each configuration.
+ */
+
+#include <array>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+#include <AMReX.H>
+#include <AMReX_iMultiFab.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_PlotFileUtil.H>
+
+// Defined and initialized when in gnumake, but not defined in cmake and
+// initialization done manually
+#ifndef AMREX_USE_SUNDIALS
+#include <AMReX_Sundials.H>
+#endif
+
+#include "PelePhysics.H"
+#include "ReactorBase.H"
+
+namespace {
+
+// Each sample holds rho, T and the mass fractions
+constexpr int SRHO = 0;
+constexpr int STEMP = 1;
+constexpr int SFS = 2;
+constexpr int NSAMP = NUM_SPECIES + 2;
+
+// Sample the states across a PMF file (columns: position, temperature,
+// velocity, density and the species mole fractions)
+amrex::Vector<amrex::Real>
+sample_pmf(
+  const std::string& pmf_datafile, const int nsamples, const amrex::Real p)
+{
+  std::ifstream infile(pmf_datafile);
+  if (!infile.is_open()) {
+    amrex::Abort("Unable to open PMF file " + pmf_datafile);
+  }
+
+  // Skip the variable names and the zone lines
+  std::string line;
+  std::getline(infile, line);
+  std::getline(infile, line);
+
+  amrex::Vector<amrex::Real> pmf_x;
+  amrex::Vector<amrex::Real> pmf_T;
+  amrex::Vector<std::array<amrex::Real, NUM_SPECIES>> pmf_X;
+  while (std::getline(infile, line)) {
+    std::istringstream sinput(line);
+    amrex::Real x = 0.0;
+    amrex::Real T = 0.0;
+    amrex::Real u = 0.0;
+    amrex::Real rho = 0.0;
+    std::array<amrex::Real, NUM_SPECIES> X = {{0.0}};
+    if (!(sinput >> x >> T >> u >> rho)) {
+      continue;
+    }
+    for (int n = 0; n < NUM_SPECIES; n++) {
+      sinput >> X[n];
+    }
+    pmf_x.push_back(x);
+    pmf_T.push_back(T);
+    pmf_X.push_back(X);
+  }
+  const int npmf = static_cast<int>(pmf_x.size());
+  if (npmf < 2) {
+    amrex::Abort("PMF file " + pmf_datafile + " has less than two lines");
+  }
+
+  auto eos = pele::physics::PhysicsType::eos();
+  amrex::Vector<amrex::Real> samples(static_cast<size_t>(nsamples) * NSAMP);
+  for (int s = 0; s < nsamples; s++) {
+    const amrex::Real x =
+      pmf_x[0] + (s + 0.5) / nsamples * (pmf_x[npmf - 1] - pmf_x[0]);
+    int i = 0;
+    while ((i < npmf - 2) && (pmf_x[i + 1] < x)) {
+      i++;
+    }
+    const amrex::Real w = (x - pmf_x[i]) / (pmf_x[i + 1] - pmf_x[i]);
+    amrex::Real T = (1.0 - w) * pmf_T[i] + w * pmf_T[i + 1];
+    amrex::Real X[NUM_SPECIES] = {0.0};
+    amrex::Real sum = 0.0;
+    for (int n = 0; n < NUM_SPECIES; n++) {
+      X[n] = amrex::max<amrex::Real>(
+        0.0, (1.0 - w) * pmf_X[i][n] + w * pmf_X[i + 1][n]);
+      sum += X[n];
+    }
+    for (amrex::Real& Xn : X) {
+      Xn /= sum;
+    }
+    amrex::Real Y[NUM_SPECIES] = {0.0};
+    amrex::Real rho = 0.0;
+    amrex::Real e = 0.0;
+    eos.X2Y(X, Y);
+    eos.PYT2RE(p, Y, T, rho, e);
+
+    amrex::Real* sample = &samples[static_cast<size_t>(s) * NSAMP];
+    sample[SRHO] = rho;
+    sample[STEMP] = T;
+    for (int n = 0; n < NUM_SPECIES; n++) {
+      sample[SFS + n] = Y[n];
+    }
+  }
+  return samples;
+}
+
+// Gather the local cells of a plotfile level (density, Temp and Y(...))
+amrex::Vector<amrex::Real>
+sample_plotfile(const std::string& plotfile, int level)
+{
+  amrex::PlotFileData pf(plotfile);
+  if (level < 0) {
+    level = pf.finestLevel();
+  }
+
+  amrex::Vector<std::string> spec_names;
+  pele::physics::eos::speciesNames<pele::physics::PhysicsType::eos_type>(
+    spec_names);
+
+  const amrex::MultiFab rho_mf = pf.get(level, "density");
+  const amrex::MultiFab T_mf = pf.get(level, "Temp");
+
+  amrex::Long nlocal = 0;
+  for (amrex::MFIter mfi(rho_mf); mfi.isValid(); ++mfi) {
+    nlocal += mfi.validbox().numPts();
+  }
+  if (nlocal == 0) {
+    amrex::Abort("No plotfile cells on this rank, use fewer ranks");
+  }
+
+  amrex::Vector<amrex::Real> samples(nlocal * NSAMP);
+  for (int comp = -2; comp < NUM_SPECIES; comp++) {
+    amrex::MultiFab Y_mf;
+    const amrex::MultiFab* mf = &rho_mf;
+    if (comp == -1) {
+      mf = &T_mf;
+    } else if (comp >= 0) {
+      Y_mf = pf.get(level, "Y(" + spec_names[comp] + ")");
+      mf = &Y_mf;
+    }
+    amrex::Long offset = 0;
+    for (amrex::MFIter mfi(*mf); mfi.isValid(); ++mfi) {
+      const amrex::Box& bx = mfi.validbox();
+      amrex::FArrayBox host_fab(bx, 1, amrex::The_Pinned_Arena());
+      host_fab.copy<amrex::RunOn::Device>((*mf)[mfi], bx);
+      amrex::Gpu::streamSynchronize();
+      auto const& arr = host_fab.const_array();
+      amrex::LoopOnCpu(bx, [&](int i, int j, int k) noexcept {
+        const amrex::Long s =
+          offset + bx.index(amrex::IntVect(AMREX_D_DECL(i, j, k)));
+        samples[s * NSAMP + SFS + comp] = arr(i, j, k);
+      });
+      offset += bx.numPts();
+    }
+  }
+  return samples;
+}
+
+// Fill the reactor data from the samples, cell n of the domain gets sample
+// n modulo the number of samples
+void
+fill_states(
+  const amrex::Box& domain,
+  const amrex::Real* samples,
+  const int nsamples,
+  amrex::MultiFab& state,
+  amrex::MultiFab& extsrc_rY,
+  amrex::MultiFab& extsrc_rE,
+  amrex::MultiFab& fctCount,
+  amrex::iMultiFab& mask)
+{
+  extsrc_rY.setVal(0.0);
+  extsrc_rE.setVal(0.0);
+  fctCount.setVal(0.0);
+  mask.setVal(1);
+
+  for (amrex::MFIter mfi(state); mfi.isValid(); ++mfi) {
+    const amrex::Box& bx = mfi.validbox();
+    auto const& rhoY = state.array(mfi);
+    auto const& T = state.array(mfi, NUM_SPECIES);
+    auto const& rhoE = state.array(mfi, NUM_SPECIES + 1);
+    amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
+      const amrex::Long n =
+        domain.index(amrex::IntVect(AMREX_D_DECL(i, j, k))) % nsamples;
+      const amrex::Real* sample = samples + n * NSAMP;
+      amrex::Real Y[NUM_SPECIES] = {0.0};
+      for (int nsp = 0; nsp < NUM_SPECIES; nsp++) {
+        Y[nsp] = sample[SFS + nsp];
+        rhoY(i, j, k, nsp) = sample[SRHO] * Y[nsp];
+      }
+      amrex::Real e = 0.0;
+      auto eos = pele::physics::PhysicsType::eos();
+      eos.RTY2E(sample[SRHO], sample[STEMP], Y, e);
+      T(i, j, k) = sample[STEMP];
+      rhoE(i, j, k) = sample[SRHO] * e;
+    });
+  }
+  amrex::Gpu::streamSynchronize();
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+  amrex::Initialize(argc, argv);
+// Defined and initialized when in gnumake, but not defined in cmake and
+// initialization done manually
+#ifndef AMREX_USE_SUNDIALS
+  amrex::sundials::Initialize(amrex::OpenMP::get_max_threads());
+#endif
+
+  {
+    BL_PROFILE("main()");
+
+    amrex::ParmParse pp("bench");
+    std::string chem_integrator = "ReactorCvode";
+    std::string pmf_datafile;
+    std::string plotfile;
+    int plotfile_level = -1;
+    int nsamples = 1024;
+    amrex::Real pressure = 1013250.0;
+    amrex::Real dt = 1.0e-6;
+    int nrep = 3;
+    amrex::Vector<int> n_cell(AMREX_SPACEDIM, 32);
+    amrex::Vector<int> box_sizes = {8, 16, 32};
+    amrex::Vector<int> batch_sizes;
+    pp.query("chem_integrator", chem_integrator);
+    pp.query("pmf_datafile", pmf_datafile);
+    pp.query("plotfile", plotfile);
+    pp.query("plotfile_level", plotfile_level);
+    pp.query("nsamples", nsamples);
+    pp.query("pressure", pressure);
+    pp.query("dt", dt);
+    pp.query("nrep", nrep);
+    pp.queryarr("n_cell", n_cell, 0, AMREX_SPACEDIM);
+    pp.queryarr("box_sizes", box_sizes);
+    pp.queryarr("batch_sizes", batch_sizes);
+
+    if (pmf_datafile.empty() == plotfile.empty()) {
+      amrex::Abort("Specify one of bench.pmf_datafile or bench.plotfile");
+    }
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(dt > 0.0, "bench.dt must be positive");
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(nrep > 0, "bench.nrep must be positive");
+
+    // Synthetic population of states
+    const amrex::Vector<amrex::Real> h_samples =
+      plotfile.empty() ? sample_pmf(pmf_datafile, nsamples, pressure)
+                       : sample_plotfile(plotfile, plotfile_level);
+    nsamples = static_cast<int>(h_samples.size() / NSAMP);
+    amrex::Gpu::DeviceVector<amrex::Real> samples(h_samples.size());
+    amrex::Gpu::copy(
+      amrex::Gpu::hostToDevice, h_samples.begin(), h_samples.end(),
+      samples.begin());
+
+    auto reactor =
+      pele::physics::reactions::ReactorBase::create(chem_integrator);
+    reactor->init(1, 1);
+
+    // Each configuration chops a domain in the boxes passed to the reactor,
+    // the batches integrate the same cells laid out in a single row
+    const amrex::Box domain(
+      amrex::IntVect(AMREX_D_DECL(0, 0, 0)),
+      amrex::IntVect(
+        AMREX_D_DECL(n_cell[0] - 1, n_cell[1] - 1, n_cell[2] - 1)));
+    const amrex::Long ncells = domain.numPts();
+    const amrex::Box row(
+      amrex::IntVect(AMREX_D_DECL(0, 0, 0)),
+      amrex::IntVect(AMREX_D_DECL(static_cast<int>(ncells - 1), 0, 0)));
+
+    struct Config
+    {
+      std::string name;
+      amrex::Box domain;
+      int size;
+    };
+    amrex::Vector<Config> configs;
+    for (const int b : box_sizes) {
+      configs.push_back({"box", domain, b});
+    }
+    for (const int b : batch_sizes) {
+      configs.push_back(
+        {"batch", row, (b > 0) ? b : static_cast<int>(ncells)});
+    }
+
+    amrex::Print() << "\nChemistry throughput: " << chem_integrator << ", "
+                   << NUM_SPECIES << " species, " << ncells
+                   << " cells per rank, " << nsamples << " samples, dt = "
+                   << dt << "\n\n";
+    amrex::Print() << std::setw(8) << "type" << std::setw(10) << "size"
+                   << std::setw(10) << "calls" << std::setw(14) << "time [s]"
+                   << std::setw(14) << "cells/s" << std::setw(14)
+                   << "RHS/cell" << std::setw(14) << "max RHS" << "\n";
+
+    for (const auto& config : configs) {
+      amrex::BoxArray ba(config.domain);
+      ba.maxSize(config.size);
+      // Every rank integrates the whole population
+      amrex::Vector<int> pmap(ba.size(), amrex::ParallelDescriptor::MyProc());
+      amrex::DistributionMapping dm(pmap);
+
+      amrex::MultiFab state(ba, dm, NUM_SPECIES + 2, 0);
+      amrex::MultiFab extsrc_rY(ba, dm, NUM_SPECIES, 0);
+      amrex::MultiFab extsrc_rE(ba, dm, 1, 0);
+      amrex::MultiFab fctCount(ba, dm, 1, 0);
+      amrex::iMultiFab mask(ba, dm, 1, 0);
+
+      amrex::Real best = std::numeric_limits<amrex::Real>::max();
+      for (int rep = 0; rep < nrep; rep++) {
+        fill_states(
+          config.domain, samples.data(), nsamples, state, extsrc_rY,
+          extsrc_rE, fctCount, mask);
+
+        amrex::ParallelDescriptor::Barrier();
+        amrex::Real wt = amrex::ParallelDescriptor::second();
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+        for (amrex::MFIter mfi(state); mfi.isValid(); ++mfi) {
+          const amrex::Box& bx = mfi.validbox();
+          auto const& rhoY = state.array(mfi);
+          auto const& T = state.array(mfi, NUM_SPECIES);
+          auto const& rhoE = state.array(mfi, NUM_SPECIES + 1);
+          auto const& frcExt = extsrc_rY.array(mfi);
+          auto const& frcEExt = extsrc_rE.array(mfi);
+          auto const& fc = fctCount.array(mfi);
+          auto const& m = mask.array(mfi);
+          amrex::Real time = 0.0;
+          reactor->react(
+            bx, rhoY, frcExt, T, rhoE, frcEExt, fc, m, dt, time
+#ifdef AMREX_USE_GPU
+            ,
+            amrex::Gpu::gpuStream()
+#endif
+          );
+        }
+        amrex::Gpu::Device::streamSynchronize();
+        wt = amrex::ParallelDescriptor::second() - wt;
+        amrex::ParallelDescriptor::ReduceRealMax(wt);
+        best = amrex::min(best, wt);
+      }
+
+      const amrex::Real fc_mean = fctCount.sum(0, true) / ncells;
+      amrex::Real fc_max = fctCount.max(0, 0, true);
+      amrex::ParallelDescriptor::ReduceRealMax(fc_max);
+      amrex::Print() << std::setw(8) << config.name << std::setw(10)
+                     << config.size << std::setw(10) << ba.size()
+                     << std::setw(14) << best << std::setw(14)
+                     << ncells / best << std::setw(14) << fc_mean
+                     << std::setw(14) << fc_max << "\n";
+    }
+    amrex::Print() << std::endl;
+
+    reactor->close();
+  }
+
+#ifndef AMREX_USE_SUNDIALS
+  amrex::sundials::Finalize();
+#endif
+  amrex::Finalize();
+
+  return 0;
+}
@@ -0,0 +1,255 @@
+/** \file eos-throughput.cpp
+ *  Standalone EOS throughput benchmark
+ *
+ *  Evaluates the thermodynamic part of the primitive state (temperature,
+ *  pressure, sound speed, gamma, dp/de, dp/drho and mean molecular weight)
+ *  from the density, internal energy and mass fractions of a population of
+ *  random states, once with the individual EOS calls and once with the fused
+ *  pc_eos_full_state used by pc_ctoprim, and reports the time per cell of
+ *  each and the largest relative difference between them. Only the Fuego
+ *  EOS has a fused evaluation, with the other EOS both evaluations are the
+ *  same individual calls.
+ */
+
+#include <iomanip>
+#include <limits>
+
+#include <AMReX.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Random.H>
+
+#include "PelePhysics.H"
+#include "Utilities.H"
+
+namespace {
+
+// Each sample holds rho, e, the temperature guess and the mass fractions
+constexpr int SRHO = 0;
+constexpr int SEINT = 1;
+constexpr int STEMP = 2;
+constexpr int SFS = 3;
+constexpr int NSAMP = NUM_SPECIES + 3;
+
+#ifdef USE_FUEGO_EOS
+constexpr bool eos_fused = true;
+#else
+constexpr bool eos_fused = false;
+#endif
+
+// Outputs of the evaluation
+constexpr int OTEMP = 0;
+constexpr int OPRES = 1;
+constexpr int OCS = 2;
+constexpr int OGAM = 3;
+constexpr int ODPDE = 4;
+constexpr int ODPDR = 5;
+constexpr int OWBAR = 6;
+constexpr int NOUT = 7;
+
+// Random states at pressure p with temperatures in [T_lo, T_hi] and random
+// mass fractions, the temperature guess is perturbed by T_guess
+amrex::Vector<amrex::Real>
+sample_states(
+  const int nsamples,
+  const amrex::Real p,
+  const amrex::Real T_lo,
+  const amrex::Real T_hi,
+  const amrex::Real T_guess)
+{
+  auto eos = pele::physics::PhysicsType::eos();
+  amrex::Vector<amrex::Real> samples(static_cast<size_t>(nsamples) * NSAMP);
+  for (int s = 0; s < nsamples; s++) {
+    const amrex::Real T = T_lo + amrex::Random() * (T_hi - T_lo);
+    amrex::Real Y[NUM_SPECIES] = {0.0};
+    amrex::Real sum = 0.0;
+    for (amrex::Real& Yn : Y) {
+      Yn = amrex::Random();
+      sum += Yn;
+    }
+    for (amrex::Real& Yn : Y) {
+      Yn /= sum;
+    }
+    amrex::Real rho = 0.0;
+    amrex::Real e = 0.0;
+    eos.PYT2RE(p, Y, T, rho, e);
+
+    amrex::Real* sample = &samples[static_cast<size_t>(s) * NSAMP];
+    sample[SRHO] = rho;
+    sample[SEINT] = e;
+    sample[STEMP] = T * (1.0 + T_guess * (2.0 * amrex::Random() - 1.0));
+    for (int n = 0; n < NUM_SPECIES; n++) {
+      sample[SFS + n] = Y[n];
+    }
+  }
+  return samples;
+}
+
+// Evaluate the states of the domain, cell n gets sample n modulo the number
+// of samples, and return the wall time
+template <bool fused>
+amrex::Real
+evaluate(
+  const amrex::Box& domain,
+  const amrex::Real* samples,
+  const int nsamples,
+  amrex::MultiFab& out)
+{
+  amrex::ParallelDescriptor::Barrier();
+  amrex::Real wt = amrex::ParallelDescriptor::second();
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+  for (amrex::MFIter mfi(out, amrex::TilingIfNotGPU()); mfi.isValid();
+       ++mfi) {
+    const amrex::Box& bx = mfi.tilebox();
+    auto const& o = out.array(mfi);
+    amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
+      const amrex::Long n =
+        domain.index(amrex::IntVect(AMREX_D_DECL(i, j, k))) % nsamples;
+      const amrex::Real* sample = samples + n * NSAMP;
+      const amrex::Real rho = sample[SRHO];
+      const amrex::Real e = sample[SEINT];
+      amrex::Real T = sample[STEMP];
+      amrex::Real massfrac[NUM_SPECIES];
+      for (int sp = 0; sp < NUM_SPECIES; sp++) {
+        massfrac[sp] = sample[SFS + sp];
+      }
+      amrex::Real dpdr_e, dpde, gam1, cs, wbar, p;
+      if constexpr (fused) {
+        pc_eos_full_state(
+          rho, e, massfrac, T, p, cs, gam1, dpde, dpdr_e, wbar);
+      } else {
+        auto eos = pele::physics::PhysicsType::eos();
+        eos.Y2WBAR(massfrac, wbar);
+        eos.REY2T(rho, e, massfrac, T);
+        eos.RTY2P(rho, T, massfrac, p);
+        eos.RTY2Cs(rho, T, massfrac, cs);
+        eos.RTY2G(rho, T, massfrac, gam1);
+        eos.RTY2dpde_dpdre(rho, T, massfrac, dpde, dpdr_e);
+      }
+      o(i, j, k, OTEMP) = T;
+      o(i, j, k, OPRES) = p;
+      o(i, j, k, OCS) = cs;
+      o(i, j, k, OGAM) = gam1;
+      o(i, j, k, ODPDE) = dpde;
+      o(i, j, k, ODPDR) = dpdr_e;
+      o(i, j, k, OWBAR) = wbar;
+    });
+  }
+  amrex::Gpu::Device::streamSynchronize();
+  wt = amrex::ParallelDescriptor::second() - wt;
+  amrex::ParallelDescriptor::ReduceRealMax(wt);
+  return wt;
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+  amrex::Initialize(argc, argv);
+
+  {
+    BL_PROFILE("main()");
+
+    amrex::ParmParse pp("bench");
+    int nsamples = 4096;
+    amrex::Real pressure = 1013250.0;
+    amrex::Real T_lo = 300.0;
+    amrex::Real T_hi = 2500.0;
+    amrex::Real T_guess = 0.01;
+    int nrep = 5;
+    int max_grid_size = 32;
+    amrex::Vector<int> n_cell(AMREX_SPACEDIM, 64);
+    pp.query("nsamples", nsamples);
+    pp.query("pressure", pressure);
+    pp.query("T_lo", T_lo);
+    pp.query("T_hi", T_hi);
+    pp.query("T_guess", T_guess);
+    pp.query("nrep", nrep);
+    pp.query("max_grid_size", max_grid_size);
+    pp.queryarr("n_cell", n_cell, 0, AMREX_SPACEDIM);
+
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+      nsamples > 0, "bench.nsamples must be positive");
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+      (T_lo > 0.0) && (T_hi >= T_lo), "bench.T_lo/T_hi are not valid");
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(nrep > 0, "bench.nrep must be positive");
+
+    const amrex::Vector<amrex::Real> h_samples =
+      sample_states(nsamples, pressure, T_lo, T_hi, T_guess);
+    amrex::Gpu::DeviceVector<amrex::Real> samples(h_samples.size());
+    amrex::Gpu::copy(
+      amrex::Gpu::hostToDevice, h_samples.begin(), h_samples.end(),
+      samples.begin());
+
+    const amrex::Box domain(
+      amrex::IntVect(AMREX_D_DECL(0, 0, 0)),
+      amrex::IntVect(
+        AMREX_D_DECL(n_cell[0] - 1, n_cell[1] - 1, n_cell[2] - 1)));
+    const amrex::Long ncells = domain.numPts();
+    amrex::BoxArray ba(domain);
+    ba.maxSize(max_grid_size);
+    // Every rank evaluates the whole domain
+    amrex::Vector<int> pmap(ba.size(), amrex::ParallelDescriptor::MyProc());
+    amrex::DistributionMapping dm(pmap);
+
+    amrex::MultiFab out_separate(ba, dm, NOUT, 0);
+    amrex::MultiFab out_fused(ba, dm, NOUT, 0);
+
+    amrex::Real best_separate = std::numeric_limits<amrex::Real>::max();
+    amrex::Real best_fused = std::numeric_limits<amrex::Real>::max();
+    for (int rep = 0; rep < nrep; rep++) {
+      best_separate = amrex::min(
+        best_separate,
+        evaluate<false>(domain, samples.data(), nsamples, out_separate));
+      best_fused = amrex::min(
+        best_fused,
+        evaluate<true>(domain, samples.data(), nsamples, out_fused));
+    }
+
+    // Largest relative difference of each output
+    amrex::Vector<amrex::Real> max_diff(NOUT, 0.0);
+    for (int n = 0; n < NOUT; n++) {
+      amrex::MultiFab diff(ba, dm, 1, 0);
+      amrex::MultiFab::Copy(diff, out_fused, n, 0, 1, 0);
+      amrex::MultiFab::Subtract(diff, out_separate, n, 0, 1, 0);
+      max_diff[n] = diff.norm0(0, 0, true) /
+                    amrex::max<amrex::Real>(
+                      out_separate.norm0(n, 0, true),
+                      std::numeric_limits<amrex::Real>::min());
+    }
+    amrex::ParallelDescriptor::ReduceRealMax(max_diff.data(), NOUT);
+
+    const amrex::Real ns_separate = 1.0e9 * best_separate / ncells;
+    const amrex::Real ns_fused = 1.0e9 * best_fused / ncells;
+    amrex::Print() << "\nEOS throughput: " << NUM_SPECIES << " species, "
+                   << ncells << " cells per rank, " << nsamples
+                   << " samples\n\n";
+    if (!eos_fused) {
+      amrex::Print() << "pc_eos_full_state has no fused evaluation for this "
+                        "EOS, it makes the individual calls\n\n";
+    }
+    amrex::Print() << std::setw(12) << "evaluation" << std::setw(14)
+                   << "time [s]" << std::setw(14) << "ns/cell" << "\n";
+    amrex::Print() << std::setw(12) << "separate" << std::setw(14)
+                   << best_separate << std::setw(14) << ns_separate << "\n";
+    amrex::Print() << std::setw(12) << (eos_fused ? "fused" : "unfused")
+                   << std::setw(14) << best_fused << std::setw(14) << ns_fused
+                   << "\n";
+    amrex::Print() << "\nSpeedup: " << best_separate / best_fused
+                   << ", savings: " << ns_separate - ns_fused << " ns/cell\n";
+    const amrex::Vector<std::string> names = {"T",    "p",      "cs",  "gamma",
+                                              "dpde", "dpdr_e", "wbar"};
+    amrex::Print() << "Max relative difference (max norm):";
+    for (int n = 0; n < NOUT; n++) {
+      amrex::Print() << " " << names[n] << " " << max_diff[n];
+    }
+    amrex::Print() << "\n" << std::endl;
+  }
+
+  amrex::Finalize();
+
+  return 0;
+}
@@ -1,3 +1,5 @@
+#include <numeric>
+
 #include "mechanism.H"
 
 #include "PeleC.H"
@@ -7,6 +9,38 @@
 #include "SprayParticles.H"
 #endif
 
+namespace {
+// Low-storage SSP Runge-Kutta schemes in Shu-Osher form. Stage k evaluates
+// L at the stage state U_k (U_0 = U^n) at time t^n + c_k dt and computes
+//   U_{k+1} = alpha_k U^n + (1 - alpha_k) (U_k + beta_k dt L(U_k)),
+// so only U^n and the current stage are kept. b_k is the weight of the
+// stage in U^{n+1}, used for the fluxes put in the flux registers.
+struct SSPRKScheme
+{
+  int nstages;
+  amrex::Real alpha[4];
+  amrex::Real beta[4];
+  amrex::Real c[4];
+  amrex::Real b[4];
+};
+
+// Three-stage third-order SSP-RK3, SSP coefficient 1
+constexpr SSPRKScheme ssprk3 = {
+  3,
+  {0.0, 0.75, 1.0 / 3.0, 0.0},
+  {1.0, 1.0, 1.0, 0.0},
+  {0.0, 1.0, 0.5, 0.0},
+  {1.0 / 6.0, 1.0 / 6.0, 2.0 / 3.0, 0.0}};
+
+// Four-stage third-order SSP-RK(4,3), SSP coefficient 2
+constexpr SSPRKScheme ssprk43 = {
+  4,
+  {0.0, 0.0, 2.0 / 3.0, 0.0},
+  {0.5, 0.5, 0.5, 0.5},
+  {0.0, 0.5, 1.0, 0.5},
+  {1.0 / 6.0, 1.0 / 6.0, 1.0 / 6.0, 0.5}};
+} // namespace
+
 amrex::Real
 PeleC::advance(
   amrex::Real time, amrex::Real dt, int amr_iteration, int amr_ncycle)
@@ -32,6 +66,11 @@ PeleC::advance(
     }
   }
 
+  // The tabulated transport coefficients are only valid on the mixing line
+  if (trans_table) {
+    check_transport_table(get_new_data(State_Type));
+  }
+
   amrex::Real dt_new;
   if (do_mol) {
     dt_new = do_mol_advance(time, dt, amr_iteration, amr_ncycle);
@@ -39,6 +78,11 @@ PeleC::advance(
     dt_new = do_sdc_advance(time, dt, amr_iteration, amr_ncycle);
   }
 
+  // The state may change after the advance (reflux, average down), so the
+  // primitive state of Sborder is not reused by the next advance
+  Sborder_ng = -1;
+  Sborder_Q_valid = false;
+
   return dt_new;
 }
 
@@ -48,6 +92,10 @@ PeleC::do_mol_advance(
 {
   BL_PROFILE("PeleC::do_mol_advance()");
 
+  if (mol_integrator != 0) {
+    return do_mol_ssprk_advance(time, dt, amr_iteration, amr_ncycle);
+  }
+
   // Check that we are not asking to advance stuff we don't know to
   // if (src_list.size() > 0) amrex::Abort("Have not integrated other sources
   // into MOL advance yet");
@@ -66,14 +114,16 @@ PeleC::do_mol_advance(
   amrex::MultiFab& S_old = get_old_data(State_Type);
   amrex::MultiFab& S_new = get_new_data(State_Type);
 
-  amrex::MultiFab molSrc(grids, dmap, NVAR, 0, amrex::MFInfo(), Factory());
+  // With a tolerance the iterations stop once converged, possibly before
+  // mol_iters, or go on up to mol_iters_max
+  const bool adaptive_iters = mol_iter_tol > 0.0;
+  const int max_mol_iters =
+    adaptive_iters ? amrex::max(mol_iters, mol_iters_max) : mol_iters;
 
-  amrex::MultiFab molSrc_old;
-  amrex::MultiFab molSrc_new;
-  if (mol_iters > 1) {
-    molSrc_old.define(grids, dmap, NVAR, 0, amrex::MFInfo(), Factory());
-    molSrc_new.define(grids, dmap, NVAR, 0, amrex::MFInfo(), Factory());
-  }
+  define_mol_workspace(max_mol_iters > 1);
+  amrex::MultiFab& molSrc = mol_src;
+  amrex::MultiFab& molSrc_old = mol_src_old;
+  amrex::MultiFab& molSrc_new = mol_src_new;
 
   if (!do_react) {
     get_new_data(Reactions_Type).setVal(0.0);
@@ -95,31 +145,34 @@ PeleC::do_mol_advance(
   AMREX_ASSERT(Sborder.nGrow() >= nGrow_FP_border);
 #endif
 
-  FillPatcherFill(Sborder, 0, NVAR, nGrow_FP_border, time, State_Type, 0);
   amrex::Real reflux_factor = 0.5;
-  getMOLSrcTerm(Sborder, molSrc, time, dt, reflux_factor);
+  fill_Sborder_getMOLSrcTerm(nGrow_FP_border, time, molSrc, dt, reflux_factor);
 
-  // Build other (non-diffusion) sources at t_old
+  // Build other (non-diffusion) sources at t_old, they are added to
+  // S^n = MOLRhs(U^n) in the state update
+  amrex::Vector<std::pair<amrex::Real, const amrex::MultiFab*>> srcs_old;
   for (int src : src_list) {
     if (src != diff_src) {
       construct_old_source(src, time, dt, amr_iteration, amr_ncycle, 0, 0);
-
-      // add sources to molsrc
-      amrex::MultiFab::Saxpy(molSrc, 1.0, *old_sources[src], 0, 0, NVAR, 0);
+      srcs_old.push_back({1.0, old_sources[src].get()});
     }
   }
 
-  if (mol_iters > 1) {
-    amrex::MultiFab::Copy(molSrc_old, molSrc, 0, 0, NVAR, 0);
+  if (max_mol_iters > 1) {
+    amrex::Vector<std::pair<amrex::Real, const amrex::MultiFab*>> terms(
+      1, {1.0, &molSrc});
+    terms.insert(terms.end(), srcs_old.begin(), srcs_old.end());
+    fused_state_update(molSrc_old, terms, 0.0, nullptr, 0);
   }
 
-  // U^* = U^n + dt*S^n
-  amrex::MultiFab::LinComb(S_new, 1.0, Sborder, 0, dt, molSrc, 0, 0, NVAR, 0);
-
   // U^{n+1,*} = U^n + dt*S^n + dt*I_R
-  if (do_react) {
-    amrex::MultiFab::Saxpy(S_new, dt, I_R, 0, FirstSpec, NUM_SPECIES, 0);
-    amrex::MultiFab::Saxpy(S_new, dt, I_R, NUM_SPECIES, Eden, 1, 0);
+  {
+    amrex::Vector<std::pair<amrex::Real, const amrex::MultiFab*>> terms = {
+      {1.0, &Sborder}, {dt, &molSrc}};
+    for (const auto& src : srcs_old) {
+      terms.push_back({dt, src.second});
+    }
+    fused_state_update(S_new, terms, dt, do_react ? &I_R : nullptr, 0);
   }
 
   computeTemp(S_new, 0);
@@ -129,37 +182,33 @@ PeleC::do_mol_advance(
     amrex::Print() << "... Computing MOL source term at t^{n+1} " << std::endl;
   }
 
-  FillPatcherFill(Sborder, 0, NVAR, nGrow_FP_border, time + dt, State_Type, 0);
-  reflux_factor = mol_iters > 1 ? 0 : 0.5;
-  getMOLSrcTerm(Sborder, molSrc, time, dt, reflux_factor);
+  reflux_factor = max_mol_iters > 1 ? 0 : 0.5;
+  fill_Sborder_getMOLSrcTerm(
+    nGrow_FP_border, time + dt, molSrc, dt, reflux_factor);
 
-  // Build other (non-diffusion) sources at t_new
-  for (int src : src_list) {
-    if (src != diff_src) {
-      construct_new_source(src, time + dt, dt, amr_iteration, amr_ncycle, 0, 0);
+  // U^{n+1.**} = 0.5*(U^n + U^{n+1,*}) + 0.5*dt*S^{n+1} = U^n + 0.5*dt*S^n +
+  // 0.5*dt*S^{n+1} + 0.5*dt*I_R
+  // NOTE: If I_R=0, we are done and U_new is the final new-time state
+  {
+    amrex::Vector<std::pair<amrex::Real, const amrex::MultiFab*>> terms = {
+      {0.5, &Sborder}, {0.5, &S_old}, {0.5 * dt, &molSrc}};
 
-      // add sources to molsrc
-      amrex::MultiFab::Saxpy(molSrc, 1.0, *new_sources[src], 0, 0, NVAR, 0);
+    // Build other (non-diffusion) sources at t_new
+    for (int src : src_list) {
+      if (src != diff_src) {
+        construct_new_source(
+          src, time + dt, dt, amr_iteration, amr_ncycle, 0, 0);
+        terms.push_back({0.5 * dt, new_sources[src].get()});
+      }
     }
+    fused_state_update(S_new, terms, 0.5 * dt, do_react ? &I_R : nullptr, 0);
   }
 
-  // U^{n+1.**} = 0.5*(U^n + U^{n+1,*}) + 0.5*dt*S^{n+1} = U^n + 0.5*dt*S^n +
-  // 0.5*dt*S^{n+1} + 0.5*dt*I_R
-  amrex::MultiFab::LinComb(S_new, 0.5, Sborder, 0, 0.5, S_old, 0, 0, NVAR, 0);
-  amrex::MultiFab::Saxpy(
-    S_new, 0.5 * dt, molSrc, 0, 0, NVAR,
-    0); //  NOTE: If I_R=0, we are done and U_new is the final new-time state
-
   if (do_react) {
-    amrex::MultiFab::Saxpy(S_new, 0.5 * dt, I_R, 0, FirstSpec, NUM_SPECIES, 0);
-    amrex::MultiFab::Saxpy(S_new, 0.5 * dt, I_R, NUM_SPECIES, Eden, 1, 0);
-
     // F_{AD} = (1/dt)(U^{n+1,**} - U^n) - I_R = 0.5*(S^{n}+S^{n+1}(which is a
     // guess!))
-    amrex::MultiFab::LinComb(
-      molSrc, 1.0 / dt, S_new, 0, -1.0 / dt, S_old, 0, 0, NVAR, 0);
-    amrex::MultiFab::Subtract(molSrc, I_R, 0, FirstSpec, NUM_SPECIES, 0);
-    amrex::MultiFab::Subtract(molSrc, I_R, NUM_SPECIES, Eden, 1, 0);
+    fused_state_update(
+      molSrc, {{1.0 / dt, &S_new}, {-1.0 / dt, &S_old}}, -1.0, &I_R, 0);
 
     // Compute I_R and U^{n+1} = U^n + dt*(F_{AD} + I_R)
     react_state(time, dt, false, &molSrc);
@@ -167,17 +216,30 @@ PeleC::do_mol_advance(
 
   computeTemp(S_new, 0);
 
-  if (do_react) {
-    for (int mol_iter = 2; mol_iter <= mol_iters; ++mol_iter) {
+  if (do_react && (max_mol_iters > 1)) {
+    // The fluxes of the last iteration are registered for refluxing, so when
+    // there are flux registers one more iteration is done after convergence
+    const bool final_iter = do_reflux && (parent->finestLevel() > 0);
+    if (adaptive_iters) {
+      iteration_change(true);
+    }
+    int mol_iter = 1;
+    amrex::Real change = -1.0;
+    bool last = false;
+    while (!last) {
+      ++mol_iter;
+      last = (mol_iter == max_mol_iters) ||
+             (final_iter && (change >= 0.0) && (change < mol_iter_tol));
       if (verbose != 0) {
         amrex::Print() << "... Re-computing MOL source term at t^{n+1} (iter = "
-                       << mol_iter << " of " << mol_iters << ")" << std::endl;
+                       << mol_iter << " of "
+                       << (adaptive_iters ? "at most " : "") << max_mol_iters
+                       << ")" << std::endl;
       }
 
-      FillPatcherFill(
-        Sborder, 0, NVAR, nGrow_FP_border, time + dt, State_Type, 0);
-      reflux_factor = mol_iter == mol_iters ? 0.5 : 0;
-      getMOLSrcTerm(Sborder, molSrc_new, time, dt, reflux_factor);
+      reflux_factor = last ? 0.5 : 0;
+      fill_Sborder_getMOLSrcTerm(
+        nGrow_FP_border, time + dt, molSrc_new, dt, reflux_factor);
 
       // F_{AD} = (1/2)(molSrc_old + molSrc_new)
       amrex::MultiFab::LinComb(
@@ -187,7 +249,119 @@ PeleC::do_mol_advance(
       react_state(time, dt, false, &molSrc);
 
       computeTemp(S_new, 0);
+
+      if (adaptive_iters && !last) {
+        change = iteration_change(false);
+        if (!final_iter && (change < mol_iter_tol)) {
+          break;
+        }
+      }
+    }
+
+    if (adaptive_iters && (verbose != 0)) {
+      amrex::Print() << "Level " << level << ": " << mol_iter
+                     << " MOL iterations, relative change " << change
+                     << std::endl;
+    }
+  }
+
+  set_body_state(S_new);
+
+  return dt;
+}
+
+amrex::Real
+PeleC::do_mol_ssprk_advance(
+  amrex::Real time, amrex::Real dt, int amr_iteration, int amr_ncycle)
+{
+  BL_PROFILE("PeleC::do_mol_ssprk_advance()");
+
+  const SSPRKScheme& scheme = (mol_integrator == 1) ? ssprk3 : ssprk43;
+
+  for (int i = 0; i < num_state_type; ++i) {
+    if ((i != Reactions_Type) || (!do_react)) {
+      state[i].allocOldData();
+      state[i].swapTimeLevels(dt);
+    }
+  }
+
+  if (do_mol_load_balance || do_react_load_balance) {
+    get_new_data(Work_Estimate_Type).setVal(0.0);
+  }
+
+  amrex::MultiFab& S_old = get_old_data(State_Type);
+  amrex::MultiFab& S_new = get_new_data(State_Type);
+
+  define_mol_workspace(false);
+  amrex::MultiFab& molSrc = mol_src;
+
+  if (!do_react) {
+    get_new_data(Reactions_Type).setVal(0.0);
+  }
+  const amrex::MultiFab& I_R = get_new_data(Reactions_Type);
+
+  set_body_state(S_old);
+  set_body_state(S_new);
+
+  int nGrow_FP_border = numGrow() + nGrowF;
+#ifdef PELE_USE_SPRAY
+  const int spray_state_ghosts = sprayStateGhosts(amr_ncycle);
+  nGrow_FP_border = amrex::max(nGrow_FP_border, spray_state_ghosts);
+  AMREX_ASSERT(Sborder.nGrow() >= nGrow_FP_border);
+#endif
+
+  for (int stage = 0; stage < scheme.nstages; ++stage) {
+    const amrex::Real stage_time = time + scheme.c[stage] * dt;
+    if (verbose != 0) {
+      amrex::Print() << "... Computing MOL source term of stage " << stage + 1
+                     << " of " << scheme.nstages << std::endl;
     }
+
+    // The stage state is the new data, which is given the stage time so
+    // that the coarse-fine ghost cells are interpolated at that time
+    if (stage > 0) {
+      state[State_Type].setNewTimeLevel(stage_time);
+    }
+    fill_Sborder_getMOLSrcTerm(
+      nGrow_FP_border, stage_time, molSrc, dt, scheme.b[stage]);
+
+    // U_{k+1} = alpha_k U^n + (1 - alpha_k) (U_k + beta_k dt (L(U_k) + I_R))
+    const amrex::Real alpha = scheme.alpha[stage];
+    const amrex::Real bdt = (1.0 - alpha) * scheme.beta[stage] * dt;
+    amrex::Vector<std::pair<amrex::Real, const amrex::MultiFab*>> terms = {
+      {1.0 - alpha, &Sborder}, {bdt, &molSrc}};
+    if (alpha != 0.0) {
+      terms.push_back({alpha, &S_old});
+    }
+
+    // Build other (non-diffusion) sources at the stage time
+    for (int src : src_list) {
+      if (src != diff_src) {
+        if (stage == 0) {
+          construct_old_source(src, time, dt, amr_iteration, amr_ncycle, 0, 0);
+          terms.push_back({bdt, old_sources[src].get()});
+        } else {
+          construct_new_source(
+            src, stage_time, dt, amr_iteration, amr_ncycle, 0, 0);
+          terms.push_back({bdt, new_sources[src].get()});
+        }
+      }
+    }
+    fused_state_update(S_new, terms, bdt, do_react ? &I_R : nullptr, 0);
+
+    computeTemp(S_new, 0);
+  }
+  state[State_Type].setNewTimeLevel(time + dt);
+
+  if (do_react) {
+    // F_{AD} = (1/dt)(U^{n+1,*} - U^n) - I_R
+    fused_state_update(
+      molSrc, {{1.0 / dt, &S_new}, {-1.0 / dt, &S_old}}, -1.0, &I_R, 0);
+
+    // Compute I_R and U^{n+1} = U^n + dt*(F_{AD} + I_R)
+    react_state(time, dt, false, &molSrc);
+
+    computeTemp(S_new, 0);
   }
 
   set_body_state(S_new);
@@ -195,6 +369,90 @@ PeleC::do_mol_advance(
   return dt;
 }
 
+void
+PeleC::define_mol_workspace(const bool need_iter_src)
+{
+  // Same lifetime as the reaction workspace, see define_react_workspace
+  if ((mol_src.boxArray() != grids) || (mol_src.DistributionMap() != dmap)) {
+    BL_PROFILE("PeleC::define_mol_workspace()");
+    mol_src.define(grids, dmap, NVAR, 0, amrex::MFInfo(), Factory());
+  }
+  if (
+    need_iter_src && ((mol_src_old.boxArray() != grids) ||
+                      (mol_src_old.DistributionMap() != dmap))) {
+    BL_PROFILE("PeleC::define_mol_workspace()");
+    mol_src_old.define(grids, dmap, NVAR, 0, amrex::MFInfo(), Factory());
+    mol_src_new.define(grids, dmap, NVAR, 0, amrex::MFInfo(), Factory());
+  }
+}
+
+void
+PeleC::clear_mol_workspace()
+{
+  mol_src.clear();
+  mol_src_old.clear();
+  mol_src_new.clear();
+  iter_S_prev.clear();
+  iter_R_prev.clear();
+}
+
+amrex::Real
+PeleC::iteration_change(const bool first)
+{
+  BL_PROFILE("PeleC::iteration_change()");
+
+  const amrex::MultiFab& S_new = get_new_data(State_Type);
+  const amrex::MultiFab& R_new = get_new_data(Reactions_Type);
+  const int nR = R_new.nComp();
+
+  if (first) {
+    if (
+      (iter_S_prev.boxArray() != grids) ||
+      (iter_S_prev.DistributionMap() != dmap)) {
+      iter_S_prev.define(grids, dmap, NVAR, 0);
+      iter_R_prev.define(grids, dmap, nR, 0);
+    }
+    amrex::MultiFab::Copy(iter_S_prev, S_new, 0, 0, NVAR, 0);
+    amrex::MultiFab::Copy(iter_R_prev, R_new, 0, 0, nR, 0);
+    return -1.0;
+  }
+
+  // Turn the previous data into the change and take the max norms of the
+  // change and of the new data of all the components in a single reduction
+  amrex::MultiFab::LinComb(
+    iter_S_prev, 1.0, S_new, 0, -1.0, iter_S_prev, 0, 0, NVAR, 0);
+  amrex::MultiFab::LinComb(
+    iter_R_prev, 1.0, R_new, 0, -1.0, iter_R_prev, 0, 0, nR, 0);
+
+  amrex::Vector<int> scomps(NVAR);
+  amrex::Vector<int> rcomps(nR);
+  std::iota(scomps.begin(), scomps.end(), 0);
+  std::iota(rcomps.begin(), rcomps.end(), 0);
+  amrex::Vector<amrex::Real> norms = iter_S_prev.norm0(scomps, 0, true);
+  const amrex::Vector<amrex::Real> dR = iter_R_prev.norm0(rcomps, 0, true);
+  const amrex::Vector<amrex::Real> S = S_new.norm0(scomps, 0, true);
+  const amrex::Vector<amrex::Real> R = R_new.norm0(rcomps, 0, true);
+  norms.insert(norms.end(), dR.begin(), dR.end());
+  norms.insert(norms.end(), S.begin(), S.end());
+  norms.insert(norms.end(), R.begin(), R.end());
+  amrex::ParallelDescriptor::ReduceRealMax(
+    norms.data(), static_cast<int>(norms.size()));
+
+  // Components that are zero everywhere are not measured
+  const int ncomp = NVAR + nR;
+  amrex::Real change = 0.0;
+  for (int n = 0; n < ncomp; ++n) {
+    if (norms[ncomp + n] > 0.0) {
+      change = amrex::max(change, norms[n] / norms[ncomp + n]);
+    }
+  }
+
+  amrex::MultiFab::Copy(iter_S_prev, S_new, 0, 0, NVAR, 0);
+  amrex::MultiFab::Copy(iter_R_prev, R_new, 0, 0, nR, 0);
+
+  return change;
+}
+
 amrex::Real
 PeleC::do_sdc_advance(
   amrex::Real time, amrex::Real dt, int amr_iteration, int amr_ncycle)
@@ -214,14 +472,45 @@ PeleC::do_sdc_advance(
     get_new_data(Work_Estimate_Type).setVal(0.0);
   }
 
-  for (int sdc_iter = 0; sdc_iter < sdc_iters; ++sdc_iter) {
-    if (sdc_iters > 1) {
-      amrex::Print() << "SDC iteration " << sdc_iter + 1 << " of " << sdc_iters
+  // With a tolerance the iterations stop once converged, possibly before
+  // sdc_iters, or go on up to sdc_iters_max. The last iteration registers the
+  // fluxes for refluxing and finalizes the spray particles, so when either is
+  // needed one more iteration is done after convergence.
+  const bool adaptive_iters = sdc_iter_tol > 0.0;
+  const int max_sdc_iters =
+    adaptive_iters ? amrex::max(sdc_iters, sdc_iters_max) : sdc_iters;
+  const bool final_iter =
+    (do_reflux && (parent->finestLevel() > 0)) || do_spray_particles;
+  int sdc_iter = 0;
+  amrex::Real change = -1.0;
+  bool last = false;
+  while (!last) {
+    last = (sdc_iter == max_sdc_iters - 1) ||
+           (final_iter && (change >= 0.0) && (change < sdc_iter_tol));
+    if (max_sdc_iters > 1) {
+      amrex::Print() << "SDC iteration " << sdc_iter + 1 << " of "
+                     << (adaptive_iters ? "at most " : "") << max_sdc_iters
                      << ".\n";
     }
 
+    // The iteration is the last one when sub_iteration == sub_ncycle - 1
     dt_new = do_sdc_iteration(
-      time, dt, amr_iteration, amr_ncycle, sdc_iter, sdc_iters);
+      time, dt, amr_iteration, amr_ncycle, sdc_iter,
+      last ? sdc_iter + 1 : max_sdc_iters + 1);
+    ++sdc_iter;
+
+    if (adaptive_iters && !last) {
+      change = iteration_change(sdc_iter == 1);
+      if (!final_iter && (change >= 0.0) && (change < sdc_iter_tol)) {
+        break;
+      }
+    }
+  }
+
+  if (adaptive_iters && (verbose != 0)) {
+    amrex::Print() << "Level " << level << ": " << sdc_iter
+                   << " SDC iterations, relative change " << change
+                   << std::endl;
   }
 
   finalize_sdc_advance(time, dt, amr_iteration, amr_ncycle);
@@ -253,26 +542,26 @@ PeleC::do_sdc_iteration(
   // Create Sborder if hydro or diffuse, with the appropriate number of grow
   // cells
   int nGrow_FP_border = 0;
-  bool fill_Sborder = false;
+  bool need_Sborder = false;
 
   if (do_hydro) {
-    fill_Sborder = true;
+    need_Sborder = true;
     nGrow_FP_border = numGrow() + nGrowF;
   } else if (do_diffuse) {
-    fill_Sborder = true;
+    need_Sborder = true;
     nGrow_FP_border = numGrow();
   }
 #ifdef PELE_USE_SPRAY
   if (do_spray_particles) {
     const int spray_state_ghosts = sprayStateGhosts(amr_ncycle);
-    fill_Sborder = true;
+    need_Sborder = true;
     nGrow_FP_border = amrex::max(nGrow_FP_border, spray_state_ghosts);
     AMREX_ASSERT(Sborder.nGrow() >= nGrow_FP_border);
   }
 #endif
 
-  if (fill_Sborder) {
-    FillPatcherFill(Sborder, 0, NVAR, nGrow_FP_border, time, State_Type, 0);
+  if (need_Sborder) {
+    fill_Sborder(nGrow_FP_border, time);
   }
 
   if (sub_iteration == 0) {
@@ -325,7 +614,7 @@ PeleC::do_sdc_iteration(
     if (do_spray_particles && level > 0) {
       nGrowDiff = amrex::max(nGrowDiff, nGrow_FP_border);
     }
-    FillPatcherFill(Sborder, 0, NVAR, nGrowDiff, time + dt, State_Type, 0);
+    fill_Sborder(nGrowDiff, time + dt);
   }
   if (do_diffuse) {
     if (verbose != 0) {
@@ -366,20 +655,150 @@ PeleC::construct_Snew(
 {
   int ng = 0;
 
-  amrex::MultiFab::Copy(S_new, S_old, 0, 0, NVAR, ng);
+  // S_new = S_old + 0.5*dt*(new + old sources) + dt*(hydro + I_R) in a
+  // single pass
+  amrex::Vector<std::pair<amrex::Real, const amrex::MultiFab*>> terms(
+    1, {1.0, &S_old});
   for (int src : src_list) {
-    amrex::MultiFab::Saxpy(S_new, 0.5 * dt, *new_sources[src], 0, 0, NVAR, ng);
-    amrex::MultiFab::Saxpy(S_new, 0.5 * dt, *old_sources[src], 0, 0, NVAR, ng);
+    terms.push_back({0.5 * dt, new_sources[src].get()});
+    terms.push_back({0.5 * dt, old_sources[src].get()});
   }
   if (do_hydro) {
-    amrex::MultiFab::Saxpy(S_new, dt, hydro_source, 0, 0, NVAR, ng);
+    terms.push_back({dt, &hydro_source});
   }
 
-  if (do_react) {
-    const amrex::MultiFab& I_R = get_new_data(Reactions_Type);
-    amrex::MultiFab::Saxpy(S_new, dt, I_R, 0, FirstSpec, NUM_SPECIES, 0);
-    amrex::MultiFab::Saxpy(S_new, dt, I_R, NUM_SPECIES, Eden, 1, 0);
+  fused_state_update(
+    S_new, terms, dt,
+    do_react ? &get_new_data(Reactions_Type) : nullptr, ng);
+}
+
+void
+PeleC::fill_Sborder(const int ng, const amrex::Real time)
+{
+  FillPatcherFill(Sborder, 0, NVAR, ng, time, State_Type, 0);
+  Sborder_ng = ng;
+  Sborder_time = time;
+  Sborder_Q_valid = false;
+}
+
+void
+PeleC::fill_Sborder_getMOLSrcTerm(
+  const int ng,
+  const amrex::Real time,
+  amrex::MultiFab& MOLSrcTerm,
+  const amrex::Real dt,
+  const amrex::Real flux_factor)
+{
+  // Only the same-level ghost cells are exchanged asynchronously, so the
+  // overlap is restricted to level 0 when no fluxes are registered for
+  // refluxing (the flux registers need the fluxes of the whole tile). The
+  // lagged transport coefficients are updated on the filled state. With EB,
+  // the extrapolation of the diffusion fluxes and the redistribution of a
+  // sub-box differ from those of the whole tile.
+  const bool overlap = mol_overlap_fill && (level == 0) &&
+                       ((parent->finestLevel() == 0) || !do_reflux) &&
+                       (transport_lag_tol <= 0.0) && !eb_in_domain;
+  if (!overlap) {
+    fill_Sborder(ng, time);
+    getMOLSrcTerm(Sborder, MOLSrcTerm, time, dt, flux_factor);
+    return;
   }
+
+  BL_PROFILE("PeleC::fill_Sborder_getMOLSrcTerm()");
+
+  // Valid data at time, as in FillPatchSingleLevel
+  amrex::Vector<amrex::MultiFab*> smf;
+  amrex::Vector<amrex::Real> stime;
+  state[State_Type].getData(smf, stime, time);
+  if (smf.size() == 1) {
+    amrex::MultiFab::Copy(Sborder, *smf[0], 0, 0, NVAR, 0);
+  } else {
+    const amrex::Real w = (stime[1] - time) / (stime[1] - stime[0]);
+    amrex::MultiFab::LinComb(
+      Sborder, w, *smf[0], 0, 1.0 - w, *smf[1], 0, 0, NVAR, 0);
+  }
+  Sborder_ng = ng;
+  Sborder_time = time;
+  Sborder_Q_valid = false;
+
+  Sborder.FillBoundary_nowait(0, NVAR, amrex::IntVect(ng), geom.periodicity());
+  getMOLSrcTerm(Sborder, MOLSrcTerm, time, dt, flux_factor, MOLSrcInterior);
+  Sborder.FillBoundary_finish();
+
+  amrex::StateDataPhysBCFunct physbcf(state[State_Type], 0, geom);
+  physbcf(Sborder, 0, NVAR, amrex::IntVect(ng), time, 0);
+  getMOLSrcTerm(Sborder, MOLSrcTerm, time, dt, flux_factor, MOLSrcBoundary);
+}
+
+bool
+PeleC::shared_primitives(const amrex::MultiFab& S, const int ng)
+{
+  if (!share_primitives || (&S != &Sborder) || (ng > Sborder_ng)) {
+    return false;
+  }
+  compute_shared_primitives();
+  return true;
+}
+
+bool
+PeleC::shared_primitives(const amrex::Real time, const int ng)
+{
+  if (!share_primitives || (time != Sborder_time) || (ng > Sborder_ng)) {
+    return false;
+  }
+  compute_shared_primitives();
+  return true;
+}
+
+void
+PeleC::compute_shared_primitives()
+{
+  if (Sborder_Q_valid) {
+    return;
+  }
+  BL_PROFILE("PeleC::compute_shared_primitives()");
+
+  const int nqaux = NQAUX > 0 ? NQAUX : 1;
+  if (
+    (Sborder_Q.nGrow() != Sborder.nGrow()) ||
+    (Sborder_Q.boxArray() != Sborder.boxArray()) ||
+    (Sborder_Q.DistributionMap() != Sborder.DistributionMap())) {
+    Sborder_Q.define(
+      grids, dmap, QVAR, Sborder.nGrow(), amrex::MFInfo(), Factory());
+    Sborder_Qaux.define(
+      grids, dmap, nqaux, Sborder.nGrow(), amrex::MFInfo(), Factory());
+  }
+
+  const bool using_rf = do_rf;
+  const amrex::Real omega = rf_omega;
+  const int axis = rf_axis;
+  const amrex::GpuArray<amrex::Real, AMREX_SPACEDIM> axis_loc = {
+    AMREX_D_DECL(rf_axis_x, rf_axis_y, rf_axis_z)};
+  const auto geomdata = geom.data();
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+  for (amrex::MFIter mfi(Sborder, amrex::TilingIfNotGPU()); mfi.isValid();
+       ++mfi) {
+    const amrex::Box gbox = mfi.growntilebox(Sborder_ng);
+    auto const& sar = Sborder.const_array(mfi);
+    auto const& qar = Sborder_Q.array(mfi);
+    auto const& qauxar = Sborder_Qaux.array(mfi);
+    BL_PROFILE("PeleC::ctoprim()");
+    amrex::ParallelFor(
+      gbox, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
+        if (using_rf) {
+          amrex::IntVect iv(AMREX_D_DECL(i, j, k));
+          amrex::Real rad = get_rotaxis_dist(iv, axis, axis_loc, geomdata);
+          pc_ctoprim(i, j, k, sar, qar, qauxar, omega, rad);
+        } else {
+          pc_ctoprim(i, j, k, sar, qar, qauxar);
+        }
+      });
+  }
+
+  Sborder_Q_valid = true;
 }
 
 void
@@ -0,0 +1,168 @@
+#include <fstream>
+#include <sstream>
+
+#include <AMReX.H>
+#include <AMReX_Utility.H>
+#include <AMReX_VisMF.H>
+
+#include "AsyncWriter.H"
+
+AsyncFileWriter::AsyncFileWriter(const int max_pending)
+  : m_max_pending(max_pending)
+{
+  AMREX_ALWAYS_ASSERT(max_pending > 0);
+  m_thread = std::thread(&AsyncFileWriter::run, this);
+}
+
+AsyncFileWriter::~AsyncFileWriter()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_cv.notify_all();
+  m_thread.join();
+}
+
+void
+AsyncFileWriter::submit(
+  std::vector<File>&& files, std::function<void()> on_done)
+{
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait(lock, [this] { return m_pending < m_max_pending; });
+    m_queue.push_back({std::move(files), std::move(on_done)});
+    m_pending++;
+  }
+  m_cv.notify_all();
+  check_failure();
+}
+
+void
+AsyncFileWriter::finish()
+{
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait(lock, [this] { return m_pending == 0; });
+  }
+  check_failure();
+}
+
+int
+AsyncFileWriter::pending()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_pending;
+}
+
+void
+AsyncFileWriter::check_failure()
+{
+  std::string failed;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    failed = m_failed;
+  }
+  if (!failed.empty()) {
+    amrex::FileOpenFailed(failed);
+  }
+}
+
+void
+AsyncFileWriter::run()
+{
+  for (;;) {
+    Batch batch;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_cv.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+      if (m_queue.empty()) {
+        return;
+      }
+      batch = std::move(m_queue.front());
+      m_queue.pop_front();
+    }
+
+    std::string failed;
+    for (auto& file : batch.files) {
+      std::ofstream ofs(
+        file.name.c_str(),
+        std::ios::out | std::ios::trunc | std::ios::binary);
+      ofs.write(
+        file.data.data(), static_cast<std::streamsize>(file.data.size()));
+      ofs.close();
+      if (!ofs.good() && failed.empty()) {
+        failed = file.name;
+      }
+      // Release the staged data as soon as it is on disk
+      std::string().swap(file.data);
+    }
+    if (failed.empty() && batch.on_done) {
+      batch.on_done();
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (!failed.empty() && m_failed.empty()) {
+        m_failed = failed;
+      }
+      m_pending--;
+    }
+    m_cv.notify_all();
+  }
+}
+
+void
+stage_multifab(
+  const amrex::MultiFab& mf,
+  const std::string& mf_name,
+  std::vector<AsyncFileWriter::File>& files)
+{
+  const int IOProc = amrex::ParallelDescriptor::IOProcessorNumber();
+  const std::string dataPrefix = amrex::VisMF::BaseName(mf_name) + "_D_";
+  const std::string dataName =
+    amrex::Concatenate(dataPrefix, amrex::ParallelDescriptor::MyProc(), 5);
+
+#ifdef AMREX_USE_GPU
+  amrex::MultiFab staged(
+    mf.boxArray(), mf.DistributionMap(), mf.nComp(), mf.nGrowVect(),
+    amrex::MFInfo().SetArena(amrex::The_Pinned_Arena()));
+  amrex::MultiFab::Copy(staged, mf, 0, 0, mf.nComp(), mf.nGrowVect());
+  amrex::Gpu::streamSynchronize();
+#else
+  const amrex::MultiFab& staged = mf;
+#endif
+
+  amrex::Vector<amrex::Long> offsets(mf.size(), 0);
+  std::ostringstream data(std::ios::out | std::ios::binary);
+  for (amrex::MFIter mfi(staged); mfi.isValid(); ++mfi) {
+    offsets[mfi.index()] = static_cast<amrex::Long>(data.tellp());
+    staged[mfi].writeOn(data);
+  }
+  std::string bytes = data.str();
+  if (!bytes.empty()) {
+    files.push_back(
+      {amrex::VisMF::DirName(mf_name) + dataName, std::move(bytes)});
+  }
+
+  // The offsets and extrema of the FABs are gathered on the IO rank
+  amrex::VisMF::Header hdr(
+    mf, amrex::VisMF::NFiles, amrex::VisMF::Header::Version_v1, true);
+  amrex::ParallelDescriptor::ReduceLongSum(
+    offsets.data(), static_cast<int>(offsets.size()), IOProc);
+  if (amrex::ParallelDescriptor::IOProcessor()) {
+    const amrex::DistributionMapping& dm = mf.DistributionMap();
+    hdr.m_fod.resize(mf.size());
+    for (int i = 0; i < mf.size(); ++i) {
+      hdr.m_fod[i] = amrex::VisMF::FabOnDisk(
+        amrex::Concatenate(dataPrefix, dm[i], 5), offsets[i]);
+    }
+    const std::string HeaderName(mf_name + "_H");
+    std::ofstream HeaderFile(
+      HeaderName.c_str(), std::ios::out | std::ios::trunc);
+    if (!HeaderFile.good()) {
+      amrex::FileOpenFailed(HeaderName);
+    }
+    HeaderFile << hdr;
+  }
+}
@@ -0,0 +1,235 @@
+#include <algorithm>
+#include <cmath>
+
+#include <AMReX_Algorithm.H>
+#include <AMReX_BLassert.H>
+
+#include "ChemCache.H"
+
+ChemCache::ChemCache(
+  const int nkey,
+  const int nval,
+  const int key_bin0,
+  const int key_bin1,
+  const int max_entries,
+  const amrex::Real tol)
+  : m_nkey(nkey),
+    m_nval(nval),
+    m_bin0(key_bin0),
+    m_bin1(key_bin1),
+    m_max_entries(max_entries),
+    m_tol(tol),
+    m_max_radius(10.0 * tol)
+{
+  AMREX_ALWAYS_ASSERT(m_max_entries > 0);
+  AMREX_ALWAYS_ASSERT(m_tol > 0.0);
+  AMREX_ALWAYS_ASSERT((m_bin0 < m_nkey) && (m_bin1 < m_nkey));
+}
+
+ChemCache::BinKey
+ChemCache::binKey(const BinKey b0, const BinKey b1)
+{
+  return b0 * (BinKey(1) << 32) + (b1 & BinKey(0xffffffff));
+}
+
+ChemCache::BinKey
+ChemCache::binIndex(const amrex::Real* key, const int comp) const
+{
+  return static_cast<BinKey>(std::floor(key[comp] / m_max_radius));
+}
+
+amrex::Real
+ChemCache::distance(const amrex::Real* key, const int id) const
+{
+  const amrex::Real* k0 = &m_keys[static_cast<size_t>(id) * m_nkey];
+  amrex::Real d = 0.0;
+  for (int n = 0; n < m_nkey; n++) {
+    d = amrex::max(d, std::abs(key[n] - k0[n]));
+  }
+  return d;
+}
+
+int
+ChemCache::find(const amrex::Real* key, int& nearest)
+{
+  nearest = -1;
+  amrex::Real dmin = m_max_radius;
+  const BinKey b0 = binIndex(key, m_bin0);
+  const BinKey b1 = binIndex(key, m_bin1);
+  for (BinKey d0 = -1; d0 <= 1; d0++) {
+    for (BinKey d1 = -1; d1 <= 1; d1++) {
+      const auto it = m_bins.find(binKey(b0 + d0, b1 + d1));
+      if (it == m_bins.end()) {
+        continue;
+      }
+      for (const int id : it->second) {
+        const amrex::Real d = distance(key, id);
+        if ((d <= m_radius[id]) && (errorEstimate(id, d) <= m_tol)) {
+          m_lru.splice(m_lru.begin(), m_lru, m_lru_pos[id]);
+          m_stats.hits++;
+          return id;
+        }
+        if (d <= dmin) {
+          dmin = d;
+          nearest = id;
+        }
+      }
+    }
+  }
+  m_stats.misses++;
+  return -1;
+}
+
+void
+ChemCache::retrieve(
+  const amrex::Real* key, const int id, amrex::Real* val) const
+{
+  const amrex::Real* k0 = &m_keys[static_cast<size_t>(id) * m_nkey];
+  const amrex::Real* v0 = &m_vals[static_cast<size_t>(id) * m_nval];
+  const amrex::Real* a0 = &m_sens[static_cast<size_t>(id) * m_nval * m_nkey];
+  for (int n = 0; n < m_nval; n++) {
+    val[n] = v0[n];
+    for (int m = 0; m < m_nkey; m++) {
+      val[n] += a0[n * m_nkey + m] * (key[m] - k0[m]);
+    }
+  }
+}
+
+void
+ChemCache::update(
+  const amrex::Real* key, const amrex::Real* val, const int nearest)
+{
+  // The nearest entry may have been replaced since the query, so the
+  // distance is checked again
+  if ((nearest >= 0) && (m_radius[nearest] > 0.0)) {
+    const amrex::Real d = distance(key, nearest);
+    if (d <= m_max_radius) {
+      std::vector<amrex::Real> lin(m_nval);
+      retrieve(key, nearest, lin.data());
+      amrex::Real err = 0.0;
+      for (int n = 0; n < m_nval; n++) {
+        err = amrex::max(err, std::abs(val[n] - lin[n]));
+      }
+      if (d > 0.0) {
+        m_curv[nearest] = amrex::max(m_curv[nearest], err / (d * d));
+      }
+      if (err <= m_tol) {
+        m_radius[nearest] = amrex::max(m_radius[nearest], d);
+        m_stats.grows++;
+        return;
+      }
+      // The new entry starts from the corrected sensitivity of its neighbor
+      correct(key, val, nearest);
+      add(key, val, nearest);
+      return;
+    }
+  }
+  add(key, val, -1);
+}
+
+void
+ChemCache::correct(
+  const amrex::Real* key, const amrex::Real* val, const int id)
+{
+  const amrex::Real* k0 = &m_keys[static_cast<size_t>(id) * m_nkey];
+  amrex::Real* a0 = &m_sens[static_cast<size_t>(id) * m_nval * m_nkey];
+  amrex::Real dk2 = 0.0;
+  for (int m = 0; m < m_nkey; m++) {
+    dk2 += (key[m] - k0[m]) * (key[m] - k0[m]);
+  }
+  if (dk2 <= 0.0) {
+    return;
+  }
+  std::vector<amrex::Real> lin(m_nval);
+  retrieve(key, id, lin.data());
+  for (int n = 0; n < m_nval; n++) {
+    const amrex::Real r = (val[n] - lin[n]) / dk2;
+    for (int m = 0; m < m_nkey; m++) {
+      a0[n * m_nkey + m] += r * (key[m] - k0[m]);
+    }
+  }
+}
+
+void
+ChemCache::add(
+  const amrex::Real* key, const amrex::Real* val, const int parent)
+{
+  // The parent entry may be evicted to make room, so its sensitivity is
+  // copied first
+  const size_t nsens = static_cast<size_t>(m_nval) * m_nkey;
+  std::vector<amrex::Real> sens(nsens, 0.0);
+  amrex::Real curv = 0.0;
+  if (parent >= 0) {
+    const amrex::Real* a0 = &m_sens[static_cast<size_t>(parent) * nsens];
+    std::copy(a0, a0 + nsens, sens.begin());
+    curv = m_curv[parent];
+  }
+
+
+  if (m_size >= m_max_entries) {
+    evict();
+  }
+
+  int id = 0;
+  if (!m_free.empty()) {
+    id = m_free.back();
+    m_free.pop_back();
+  } else {
+    id = static_cast<int>(m_radius.size());
+    m_keys.resize(m_keys.size() + m_nkey);
+    m_vals.resize(m_vals.size() + m_nval);
+    m_sens.resize(m_sens.size() + nsens);
+    m_curv.push_back(0.0);
+    m_radius.push_back(0.0);
+    m_bin.push_back(0);
+    m_lru_pos.push_back(m_lru.end());
+  }
+
+  std::copy(key, key + m_nkey, &m_keys[static_cast<size_t>(id) * m_nkey]);
+  std::copy(val, val + m_nval, &m_vals[static_cast<size_t>(id) * m_nval]);
+  std::copy(
+    sens.begin(), sens.end(), &m_sens[static_cast<size_t>(id) * nsens]);
+  m_curv[id] = curv;
+  m_radius[id] = m_tol;
+  m_bin[id] = binKey(binIndex(key, m_bin0), binIndex(key, m_bin1));
+  m_bins[m_bin[id]].push_back(id);
+  m_lru.push_front(id);
+  m_lru_pos[id] = m_lru.begin();
+  m_size++;
+  m_stats.adds++;
+}
+
+void
+ChemCache::evict()
+{
+  const int id = m_lru.back();
+  m_lru.pop_back();
+
+  auto it = m_bins.find(m_bin[id]);
+  AMREX_ASSERT(it != m_bins.end());
+  auto& ids = it->second;
+  auto pos = std::find(ids.begin(), ids.end(), id);
+  AMREX_ASSERT(pos != ids.end());
+  *pos = ids.back();
+  ids.pop_back();
+  if (ids.empty()) {
+    m_bins.erase(it);
+  }
+
+  m_radius[id] = 0.0;
+  m_lru_pos[id] = m_lru.end();
+  m_free.push_back(id);
+  m_size--;
+  m_stats.evictions++;
+}
+
+amrex::Long
+ChemCache::bytes() const
+{
+  const auto nalloc = static_cast<amrex::Long>(m_radius.size());
+  const amrex::Long per_entry =
+    (m_nkey + m_nval + m_nval * m_nkey + 2) * sizeof(amrex::Real) +
+    sizeof(BinKey) + sizeof(std::list<int>::iterator) + 3 * sizeof(void*) +
+    sizeof(int);
+  return nalloc * per_entry;
+}
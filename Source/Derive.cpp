@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include "mechanism.H"
 
 #include "Utilities.H"
@@ -868,6 +870,88 @@ PeleC::pc_derdiffusivity(
   });
 }
 
+namespace {
+// Names of the derived variables in BatchDeriveVar order
+const amrex::Array<std::string, NumBatchDerive> batch_derive_names = {
+  "pressure",   "kineng",     "soundspeed", "MachNumber", "magvel",
+  "magmom",     "x_velocity", "y_velocity", "z_velocity", "massfrac",
+  "molefrac",   "cp",         "cv",         "divu",       "magvort",
+  "enstrophy"};
+} // namespace
+
+void
+PeleC::deriveBatch(
+  const amrex::Vector<std::string>& names,
+  amrex::Real time,
+  amrex::MultiFab& mf,
+  int dcomp,
+  const amrex::MultiFab* state)
+{
+  BL_PROFILE("PeleC::deriveBatch()");
+
+  const int ngrow = mf.nGrow();
+  amrex::GpuArray<int, NumBatchDerive> comp;
+  for (int v = 0; v < NumBatchDerive; v++) {
+    comp[v] = -1;
+  }
+  bool do_batch = false;
+  bool need_grad = false;
+  int cnt = dcomp;
+  for (const auto& name : names) {
+    const amrex::DeriveRec* rec = derive_lst.get(name);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+      rec != nullptr, "PeleC::deriveBatch: unknown derived variable " + name);
+    const auto it = std::find(
+      batch_derive_names.begin(), batch_derive_names.end(), rec->name());
+    if ((it != batch_derive_names.end()) && (rec->name() == name)) {
+      const auto v =
+        static_cast<int>(std::distance(batch_derive_names.begin(), it));
+      comp[v] = cnt;
+      do_batch = true;
+      need_grad = need_grad || (v >= BatchDivU);
+    } else {
+      auto derive_dat = derive(name, time, ngrow);
+      amrex::MultiFab::Copy(
+        mf, *derive_dat, 0, cnt, rec->numDerive(), ngrow);
+    }
+    cnt += rec->numDerive();
+  }
+  if (!do_batch) {
+    return;
+  }
+
+  // The state is filled once for all the batched variables
+  const int nghost = ngrow + (need_grad ? 1 : 0);
+  amrex::MultiFab S_fill;
+  if ((state == nullptr) || (state->nGrow() < nghost)) {
+    S_fill.define(grids, dmap, NVAR, nghost, amrex::MFInfo(), Factory());
+    FillPatch(*this, S_fill, nghost, time, State_Type, Density, NVAR, 0);
+    state = &S_fill;
+  }
+
+  const auto dx = geom.CellSizeArray();
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+  for (amrex::MFIter mfi(mf, amrex::TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+    const amrex::Box& bx = mfi.growntilebox(ngrow);
+    auto const& dat = state->const_array(mfi);
+    auto const& der = mf.array(mfi);
+
+    const auto& flag_fab = amrex::getEBCellFlagFab((*state)[mfi]);
+    const auto& typ = flag_fab.getType(bx);
+    const bool covered = typ == amrex::FabType::covered;
+    const bool all_regular = typ == amrex::FabType::regular;
+    const auto& flags = flag_fab.const_array();
+
+    amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
+      pc_derbatch_cell(
+        i, j, k, dat, flags, all_regular, covered, dx, comp, der);
+    });
+  }
+}
+
 #ifdef PELE_USE_MASA
 void
 pc_derrhommserror(
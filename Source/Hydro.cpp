@@ -57,6 +57,14 @@ PeleC::construct_hydro_source(
       dynamic_cast<amrex::EBFArrayBoxFactory const&>(S.Factory());
     auto const& flags = fact.getMultiEBCellFlagFab();
 
+    // Primitive state shared with the other operators evaluated on Sborder
+    const bool shared_q = !do_rf && shared_primitives(S, numGrow() + nGrowF);
+
+    // Courant number of the advance, reduced over the tiles
+    amrex::ReduceOps<amrex::ReduceOpMax> reduce_op;
+    amrex::ReduceData<amrex::Real> reduce_data(reduce_op);
+    using ReduceTuple = typename decltype(reduce_data)::Type;
+
 #ifdef AMREX_USE_OMP
 #pragma omp parallel if (amrex::Gpu::notInLaunchRegion()) \
   reduction(max : courno)
@@ -101,7 +109,22 @@ PeleC::construct_hydro_source(
         auto const& qauxar = qaux.array();
         auto const& srcqarr = src_q.array();
 
-        {
+        if (shared_q) {
+          auto const& qsh = Sborder_Q.const_array(mfi);
+          auto const& qauxsh = Sborder_Qaux.const_array(mfi);
+          amrex::ParallelFor(
+            qbx, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
+              const bool covered = flag_arr(i, j, k).isCovered();
+              for (int n = 0; n < QVAR; n++) {
+                qarr(i, j, k, n) = covered ? 0.0 : qsh(i, j, k, n);
+              }
+              if (!covered) {
+                for (int n = 0; n < NQAUX; n++) {
+                  qauxar(i, j, k, n) = qauxsh(i, j, k, n);
+                }
+              }
+            });
+        } else {
           BL_PROFILE("PeleC::ctoprim()");
           amrex::ParallelFor(
             qbx, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
@@ -115,6 +138,24 @@ PeleC::construct_hydro_source(
             });
         }
 
+        // Courant number of the advance, reused by the timestep estimate
+        if (estdt_reuse_courno) {
+          reduce_op.eval(
+            bx, reduce_data,
+            [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept -> ReduceTuple {
+              amrex::Real cfl_cell = 0.0;
+              if (!flag_arr(i, j, k).isCovered()) {
+                const amrex::Real c = qauxar(i, j, k, QC);
+                for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+                  cfl_cell = amrex::max<amrex::Real>(
+                    cfl_cell,
+                    dt * (c + std::abs(qarr(i, j, k, QU + dir))) / dx[dir]);
+                }
+              }
+              return {cfl_cell};
+            });
+        }
+
         // TODO GPUize NCSCBC
         // Imposing Ghost-Cells Navier-Stokes Characteristic BCs if "UserBC" are
         // used For the theory, see Motheau et al. AIAA J. Vol. 55, No. 10 : pp.
@@ -288,6 +329,13 @@ PeleC::construct_hydro_source(
       }
     }
 
+    if (estdt_reuse_courno) {
+      courno = amrex::max<amrex::Real>(
+        courno, amrex::get<0>(reduce_data.value(reduce_op)));
+      hydro_courno = courno;
+      hydro_courno_dt = dt;
+    }
+
     if (courno > 1.0) {
       amrex::Print() << "WARNING -- EFFECTIVE CFL AT THIS LEVEL " << level
                      << " IS " << courno << '\n';
@@ -39,6 +39,8 @@ int current_version = 1;
 std::string body_state_filename = "body_state.fab";
 } // namespace
 
+const std::string checkpoint_pending_file = "CheckpointPending";
+
 // I/O routines for PeleC
 
 bool
@@ -72,6 +74,34 @@ PeleC::check_state_in_checkpoint(const StateType state_type)
 void
 PeleC::restart(amrex::Amr& papa, std::istream& is, bool bReadSpecial)
 {
+  // Reject checkpoints whose asynchronous write did not complete
+  if (level == 0) {
+    std::string restart_file = papa.theRestartFile();
+    while (restart_file.size() > 1 && restart_file.back() == '/') {
+      restart_file.pop_back();
+    }
+    const std::string temp_suffix = ".temp";
+    int incomplete =
+      (restart_file.size() > temp_suffix.size() &&
+       restart_file.compare(
+         restart_file.size() - temp_suffix.size(), temp_suffix.size(),
+         temp_suffix) == 0)
+        ? 1
+        : 0;
+    if (amrex::ParallelDescriptor::IOProcessor()) {
+      if (amrex::FileExists(restart_file + "/" + checkpoint_pending_file)) {
+        incomplete = 1;
+      }
+    }
+    amrex::ParallelDescriptor::Bcast(
+      &incomplete, 1, amrex::ParallelDescriptor::IOProcessorNumber());
+    if (incomplete != 0) {
+      amrex::Abort(
+        "Checkpoint " + restart_file +
+        " is incomplete, restart from an earlier checkpoint");
+    }
+  }
+
   // Let's check PeleC checkpoint version first;
   // trying to read from checkpoint; if nonexisting, set it to 0.
   if (input_version == -1) {
@@ -227,6 +257,8 @@ PeleC::set_state_in_checkpoint(amrex::Vector<int>& state_in_checkpoint)
     } else if (i == Work_Estimate_Type) {
       // Never use work estimate checkpoint
       state_in_checkpoint[i] = 0;
+    } else if (i == Chem_Step_Type) {
+      state_in_checkpoint[i] = is_present ? 1 : 0;
     } else {
       amrex::Abort("Unknown StateType");
     }
@@ -248,6 +280,75 @@ PeleC::checkPoint(
   }
 #endif
 
+  writeCheckPointFiles(dir);
+}
+
+void
+PeleC::checkPointAsync(
+  const std::string& dir,
+  std::ostream& os,
+  std::vector<AsyncFileWriter::File>& files,
+  amrex::Vector<std::string>& fa_header_names)
+{
+  BL_PROFILE("PeleC::checkPointAsync()");
+
+  // Same headers as AmrLevel::checkPoint and StateData::checkPoint, the
+  // level directory is built by the caller
+  const std::string LevelDir = "Level_" + std::to_string(level);
+  const int ndesc = desc_lst.size();
+  if (amrex::ParallelDescriptor::IOProcessor()) {
+    os << level << '\n' << geom << '\n';
+    grids.writeOn(os);
+    os << ndesc << '\n';
+  }
+
+  // Every state gets a header entry, the states not stored in checkpoints
+  // are announced with no data set
+  for (int i = 0; i < ndesc; ++i) {
+    const amrex::StateData& sd = state[i];
+    const bool stored = desc_lst[i].store_in_checkpoint();
+    const bool write_old = dump_old && sd.hasOldData();
+    const std::string name = amrex::Concatenate(LevelDir + "/SD_", i, 1);
+    if (amrex::ParallelDescriptor::IOProcessor()) {
+      os << sd.getDomain() << '\n';
+      sd.boxArray().writeOn(os);
+      os << '\n'
+         << sd.getOldTimeInterval().start << '\n'
+         << sd.getOldTimeInterval().stop << '\n'
+         << sd.getNewTimeInterval().start << '\n'
+         << sd.getNewTimeInterval().stop << '\n';
+      if (!stored) {
+        os << 0 << '\n';
+      } else if (write_old) {
+        os << 2 << '\n' << name << "_New\n" << name << "_Old\n";
+      } else {
+        os << 1 << '\n' << name << "_New\n";
+      }
+    }
+    if (!stored) {
+      continue;
+    }
+
+    fa_header_names.push_back(name + "_New");
+    stage_multifab(sd.newData(), dir + "/" + name + "_New", files);
+    if (write_old) {
+      fa_header_names.push_back(name + "_Old");
+      stage_multifab(sd.oldData(), dir + "/" + name + "_Old", files);
+    }
+  }
+
+#ifdef PELE_USE_SPRAY
+  if (SprayPC != nullptr) {
+    SprayPC->SprayParticleIO(level, true, dir);
+  }
+#endif
+
+  writeCheckPointFiles(dir);
+}
+
+void
+PeleC::writeCheckPointFiles(const std::string& dir)
+{
   if (level == 0 && amrex::ParallelDescriptor::IOProcessor()) {
     {
       std::ofstream PeleCHeaderFile;
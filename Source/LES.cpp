@@ -244,18 +244,24 @@ PeleC::getSmagorinskyLESTerm(
   const int ngrow = 1;
   const amrex::GpuArray<amrex::Real, AMREX_SPACEDIM> dx = geom.CellSizeArray();
 
-  amrex::MultiFab S(grids, dmap, NVAR, ngrow, amrex::MFInfo(), Factory());
-  FillPatch(*this, S, ngrow, time, State_Type, 0, NVAR);
+  // Reuse the primitive state of Sborder when it holds the state at this time
+  const bool shared_q = !do_rf && shared_primitives(time, ngrow);
+  amrex::MultiFab S;
+  if (!shared_q) {
+    S.define(grids, dmap, NVAR, ngrow, amrex::MFInfo(), Factory());
+    FillPatch(*this, S, ngrow, time, State_Type, 0, NVAR);
+  }
 
   auto const& fact =
-    dynamic_cast<amrex::EBFArrayBoxFactory const&>(S.Factory());
+    dynamic_cast<amrex::EBFArrayBoxFactory const&>(LESTerm.Factory());
   auto const& flags = fact.getMultiEBCellFlagFab();
 
 #ifdef AMREX_USE_OMP
 #pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
 #endif
   {
-    for (amrex::MFIter mfi(S, amrex::TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+    for (amrex::MFIter mfi(LESTerm, amrex::TilingIfNotGPU()); mfi.isValid();
+         ++mfi) {
       const amrex::Box vbox = mfi.tilebox();
       const amrex::Box gbox = amrex::grow(vbox, ngrow);
       const amrex::Box cbox = amrex::grow(vbox, ngrow - 1);
@@ -269,21 +275,29 @@ PeleC::getSmagorinskyLESTerm(
         continue;
       }
 
-      auto const& s = S.array(mfi);
-      int nqaux = NQAUX > 0 ? NQAUX : 1;
-      amrex::FArrayBox q(gbox, QVAR, amrex::The_Async_Arena());
-      amrex::FArrayBox qaux(gbox, nqaux, amrex::The_Async_Arena());
-      auto const& q_ar = q.array();
-      auto const& qauxar = qaux.array();
-
-      // Get primitives, Q, including (Y, T, p, rho) from conserved state
-      // required for L term
-      {
-        BL_PROFILE("PeleC::ctoprim()");
-        amrex::ParallelFor(
-          gbox, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
-            pc_ctoprim(i, j, k, s, q_ar, qauxar);
-          });
+      amrex::FArrayBox q;
+      amrex::FArrayBox qaux;
+      amrex::Array4<amrex::Real> q_ar;
+      if (shared_q) {
+        q_ar = Sborder_Q.array(mfi);
+      } else {
+        auto const& s = S.array(mfi);
+        int nqaux = NQAUX > 0 ? NQAUX : 1;
+        q.resize(gbox, QVAR, amrex::The_Async_Arena());
+        qaux.resize(gbox, nqaux, amrex::The_Async_Arena());
+        q_ar = q.array();
+        auto const& qar = q.array();
+        auto const& qauxar = qaux.array();
+
+        // Get primitives, Q, including (Y, T, p, rho) from conserved state
+        // required for L term
+        {
+          BL_PROFILE("PeleC::ctoprim()");
+          amrex::ParallelFor(
+            gbox, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
+              pc_ctoprim(i, j, k, s, qar, qauxar);
+            });
+        }
       }
 
       // Get the tangential derivatives
@@ -632,18 +646,24 @@ PeleC::getWALELESTerm(
   const int ngrow = 1;
   const amrex::GpuArray<amrex::Real, AMREX_SPACEDIM> dx = geom.CellSizeArray();
 
-  amrex::MultiFab S(grids, dmap, NVAR, ngrow, amrex::MFInfo(), Factory());
-  FillPatch(*this, S, ngrow, time, State_Type, 0, NVAR);
+  // Reuse the primitive state of Sborder when it holds the state at this time
+  const bool shared_q = !do_rf && shared_primitives(time, ngrow);
+  amrex::MultiFab S;
+  if (!shared_q) {
+    S.define(grids, dmap, NVAR, ngrow, amrex::MFInfo(), Factory());
+    FillPatch(*this, S, ngrow, time, State_Type, 0, NVAR);
+  }
 
   auto const& fact =
-    dynamic_cast<amrex::EBFArrayBoxFactory const&>(S.Factory());
+    dynamic_cast<amrex::EBFArrayBoxFactory const&>(LESTerm.Factory());
   auto const& flags = fact.getMultiEBCellFlagFab();
 
 #ifdef AMREX_USE_OMP
 #pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
 #endif
   {
-    for (amrex::MFIter mfi(S, amrex::TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+    for (amrex::MFIter mfi(LESTerm, amrex::TilingIfNotGPU()); mfi.isValid();
+         ++mfi) {
       const amrex::Box vbox = mfi.tilebox();
       const amrex::Box gbox = amrex::grow(vbox, ngrow);
       const amrex::Box cbox = amrex::grow(vbox, ngrow - 1);
@@ -657,21 +677,29 @@ PeleC::getWALELESTerm(
         continue;
       }
 
-      auto const& s = S.array(mfi);
-      int nqaux = NQAUX > 0 ? NQAUX : 1;
-      amrex::FArrayBox q(gbox, QVAR, amrex::The_Async_Arena());
-      amrex::FArrayBox qaux(gbox, nqaux, amrex::The_Async_Arena());
-      auto const& q_ar = q.array();
-      auto const& qauxar = qaux.array();
-
-      // Get primitives, Q, including (Y, T, p, rho) from conserved state
-      // required for L term
-      {
-        BL_PROFILE("PeleC::ctoprim()");
-        amrex::ParallelFor(
-          gbox, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
-            pc_ctoprim(i, j, k, s, q_ar, qauxar);
-          });
+      amrex::FArrayBox q;
+      amrex::FArrayBox qaux;
+      amrex::Array4<amrex::Real> q_ar;
+      if (shared_q) {
+        q_ar = Sborder_Q.array(mfi);
+      } else {
+        auto const& s = S.array(mfi);
+        int nqaux = NQAUX > 0 ? NQAUX : 1;
+        q.resize(gbox, QVAR, amrex::The_Async_Arena());
+        qaux.resize(gbox, nqaux, amrex::The_Async_Arena());
+        q_ar = q.array();
+        auto const& qar = q.array();
+        auto const& qauxar = qaux.array();
+
+        // Get primitives, Q, including (Y, T, p, rho) from conserved state
+        // required for L term
+        {
+          BL_PROFILE("PeleC::ctoprim()");
+          amrex::ParallelFor(
+            gbox, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
+              pc_ctoprim(i, j, k, s, qar, qauxar);
+            });
+        }
       }
 
       // Get the tangential derivatives
@@ -739,18 +767,24 @@ PeleC::getVremanLESTerm(
   const int ngrow = 1;
   const amrex::GpuArray<amrex::Real, AMREX_SPACEDIM> dx = geom.CellSizeArray();
 
-  amrex::MultiFab S(grids, dmap, NVAR, ngrow, amrex::MFInfo(), Factory());
-  FillPatch(*this, S, ngrow, time, State_Type, 0, NVAR);
+  // Reuse the primitive state of Sborder when it holds the state at this time
+  const bool shared_q = !do_rf && shared_primitives(time, ngrow);
+  amrex::MultiFab S;
+  if (!shared_q) {
+    S.define(grids, dmap, NVAR, ngrow, amrex::MFInfo(), Factory());
+    FillPatch(*this, S, ngrow, time, State_Type, 0, NVAR);
+  }
 
   auto const& fact =
-    dynamic_cast<amrex::EBFArrayBoxFactory const&>(S.Factory());
+    dynamic_cast<amrex::EBFArrayBoxFactory const&>(LESTerm.Factory());
   auto const& flags = fact.getMultiEBCellFlagFab();
 
 #ifdef AMREX_USE_OMP
 #pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
 #endif
   {
-    for (amrex::MFIter mfi(S, amrex::TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+    for (amrex::MFIter mfi(LESTerm, amrex::TilingIfNotGPU()); mfi.isValid();
+         ++mfi) {
       const amrex::Box vbox = mfi.tilebox();
       const amrex::Box gbox = amrex::grow(vbox, ngrow);
       const amrex::Box cbox = amrex::grow(vbox, ngrow - 1);
@@ -764,21 +798,29 @@ PeleC::getVremanLESTerm(
         continue;
       }
 
-      auto const& s = S.array(mfi);
-      int nqaux = NQAUX > 0 ? NQAUX : 1;
-      amrex::FArrayBox q(gbox, QVAR, amrex::The_Async_Arena());
-      amrex::FArrayBox qaux(gbox, nqaux, amrex::The_Async_Arena());
-      auto const& q_ar = q.array();
-      auto const& qauxar = qaux.array();
-
-      // Get primitives, Q, including (Y, T, p, rho) from conserved state
-      // required for L term
-      {
-        BL_PROFILE("PeleC::ctoprim()");
-        amrex::ParallelFor(
-          gbox, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
-            pc_ctoprim(i, j, k, s, q_ar, qauxar);
-          });
+      amrex::FArrayBox q;
+      amrex::FArrayBox qaux;
+      amrex::Array4<amrex::Real> q_ar;
+      if (shared_q) {
+        q_ar = Sborder_Q.array(mfi);
+      } else {
+        auto const& s = S.array(mfi);
+        int nqaux = NQAUX > 0 ? NQAUX : 1;
+        q.resize(gbox, QVAR, amrex::The_Async_Arena());
+        qaux.resize(gbox, nqaux, amrex::The_Async_Arena());
+        q_ar = q.array();
+        auto const& qar = q.array();
+        auto const& qauxar = qaux.array();
+
+        // Get primitives, Q, including (Y, T, p, rho) from conserved state
+        // required for L term
+        {
+          BL_PROFILE("PeleC::ctoprim()");
+          amrex::ParallelFor(
+            gbox, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
+              pc_ctoprim(i, j, k, s, qar, qauxar);
+            });
+        }
       }
 
       // Get the tangential derivatives
@@ -9,4 +9,26 @@ PeleAscent::PeleAscent()
     pp.query("plot_int", plot_int);
   }
 }
+
+PeleAscent::~PeleAscent()
+{
+  if (is_open) {
+    session.close();
+  }
+}
+
+void
+PeleAscent::open()
+{
+  if (is_open) {
+    return;
+  }
+  conduit::Node open_opts;
+#ifdef AMREX_USE_MPI
+  open_opts["mpi_comm"] =
+    MPI_Comm_c2f(amrex::ParallelDescriptor::Communicator());
+#endif
+  session.open(open_opts);
+  is_open = true;
+}
 } // namespace pele
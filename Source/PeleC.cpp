@@ -92,6 +92,9 @@ int PeleC::eb_max_lvl_gen = -1;
 bool PeleC::body_state_set = false;
 amrex::GpuArray<amrex::Real, NVAR> PeleC::body_state;
 
+std::unique_ptr<ChemCache> PeleC::chem_cache;
+std::unique_ptr<TransportTable> PeleC::trans_table;
+
 bool PeleC::do_react_load_balance = false;
 bool PeleC::do_mol_load_balance = false;
 
@@ -108,6 +111,7 @@ pele::physics::turbinflow::TurbInflow PeleC::turb_inflow;
 amrex::Vector<std::string> PeleC::m_diagVars;
 
 amrex::Vector<int> PeleC::src_list;
+bool PeleC::workspace_report_pending = true;
 
 // this will be reset upon restart
 amrex::Real PeleC::previousCPUTimeUsed = 0.0;
@@ -716,6 +720,9 @@ PeleC::initData()
   }
 
   get_new_data(Reactions_Type).setVal(0.0);
+  if (do_react && react_sort_by_cost) {
+    get_new_data(Chem_Step_Type).setVal(0.0);
+  }
 
   if (do_mol_load_balance || do_react_load_balance) {
     get_new_data(Work_Estimate_Type).setVal(1.0);
@@ -790,6 +797,12 @@ PeleC::init(AmrLevel& old)
       old, work_estimate_new, 0, cur_time, Work_Estimate_Type, 0,
       work_estimate_new.nComp());
   }
+
+  if (do_react && react_sort_by_cost) {
+    amrex::MultiFab& chem_dt_new = get_new_data(Chem_Step_Type);
+    FillPatch(
+      old, chem_dt_new, 0, cur_time, Chem_Step_Type, 0, chem_dt_new.nComp());
+  }
 }
 
 void
@@ -816,6 +829,12 @@ PeleC::init()
     FillCoarsePatch(
       work_estimate_new, 0, cur_time, Work_Estimate_Type, 0, ncomp);
   }
+
+  if (do_react && react_sort_by_cost) {
+    amrex::MultiFab& chem_dt_new = get_new_data(Chem_Step_Type);
+    FillCoarsePatch(
+      chem_dt_new, 0, cur_time, Chem_Step_Type, 0, chem_dt_new.nComp());
+  }
 }
 
 amrex::Real
@@ -848,8 +867,6 @@ PeleC::estTimeStep(amrex::Real /*dt_old*/)
 
   const amrex::MultiFab& stateMF = get_new_data(State_Type);
 
-  const amrex::Real* dx = geom.CellSize();
-
   std::string limiter = "pelec.max_dt";
 
   // Start the hydro with the max_dt value, but divide by CFL
@@ -858,95 +875,104 @@ PeleC::estTimeStep(amrex::Real /*dt_old*/)
   // criterion, we will get exactly max_dt for a timestep.
 
   const amrex::Real max_dt_over_cfl = max_dt / cfl;
-  amrex::Real estdt_hydro = max_dt_over_cfl;
-  amrex::Real estdt_vdif = max_dt_over_cfl;
-  amrex::Real estdt_tdif = max_dt_over_cfl;
-  amrex::Real estdt_edif = max_dt_over_cfl;
   if (do_hydro || do_mol || diffuse_vel || diffuse_temp || diffuse_enth) {
 
-    auto const& fact =
-      dynamic_cast<amrex::EBFArrayBoxFactory const&>(stateMF.Factory());
-    auto const& flags = fact.getMultiEBCellFlagFab();
-
-    amrex::Real AMREX_D_DECL(dx1 = dx[0], dx2 = dx[1], dx3 = dx[2]);
-
-    if (do_hydro) {
-      amrex::Real dt = amrex::ReduceMin(
-        stateMF, flags, 0,
-        [=] AMREX_GPU_HOST_DEVICE(
-          amrex::Box const& bx, const amrex::Array4<const amrex::Real>& fab_arr,
-          const amrex::Array4<const amrex::EBCellFlag>& flag_arr)
-          -> amrex::Real {
-          return pc_estdt_hydro(
-            bx, fab_arr, flag_arr, AMREX_D_DECL(dx1, dx2, dx3));
-        });
-      estdt_hydro = amrex::min<amrex::Real>(estdt_hydro, dt);
+    // The hydrodynamic limit of the Godunov advance can be recovered from the
+    // Courant number of the last advance, sparing its evaluation here
+    const bool reuse_courno = estdt_reuse_courno && do_hydro && !do_mol &&
+                              (hydro_courno > 0.0) && (hydro_courno_dt > 0.0);
+
+    amrex::GpuArray<bool, NumDtLimits> which;
+    which[DtHydro] = do_hydro && !reuse_courno;
+    which[DtVelDif] = diffuse_vel;
+    which[DtTempDif] = diffuse_temp;
+    which[DtEnthDif] = diffuse_enth;
+
+    amrex::Vector<amrex::Real> estdt_limits(NumDtLimits, max_dt_over_cfl);
+    if (reuse_courno) {
+      estdt_limits[DtHydro] = amrex::min<amrex::Real>(
+        max_dt_over_cfl, hydro_courno_dt / hydro_courno);
     }
 
-    if (diffuse_vel) {
+    // Single sweep evaluating all the selected constraints
+    if (which[DtHydro] || which[DtVelDif] || which[DtTempDif] ||
+        which[DtEnthDif]) {
+      auto const& fact =
+        dynamic_cast<amrex::EBFArrayBoxFactory const&>(stateMF.Factory());
+      auto const& flags = fact.getMultiEBCellFlagFab();
       auto const& geomdata = geom.data();
       auto const* ltransparm = trans_parms.device_parm();
       const ProbParmDevice* lprobparm = PeleC::d_prob_parm_device;
-      amrex::Real dt = amrex::ReduceMin(
-        stateMF, flags, 0,
-        [=] AMREX_GPU_HOST_DEVICE(
-          amrex::Box const& bx, const amrex::Array4<const amrex::Real>& fab_arr,
-          const amrex::Array4<const amrex::EBCellFlag>& flag_arr)
-          -> amrex::Real {
-          return pc_estdt_veldif(
-            bx, fab_arr, flag_arr, geomdata, ltransparm, *lprobparm);
-        });
-      estdt_vdif = amrex::min<amrex::Real>(estdt_vdif, dt);
-    }
 
-    if (diffuse_temp) {
-      auto const& geomdata = geom.data();
-      auto const* ltransparm = trans_parms.device_parm();
-      const ProbParmDevice* lprobparm = PeleC::d_prob_parm_device;
-      amrex::Real dt = amrex::ReduceMin(
-        stateMF, flags, 0,
-        [=] AMREX_GPU_HOST_DEVICE(
-          amrex::Box const& bx, const amrex::Array4<const amrex::Real>& fab_arr,
-          const amrex::Array4<const amrex::EBCellFlag>& flag_arr)
-          -> amrex::Real {
-          return pc_estdt_tempdif(
-            bx, fab_arr, flag_arr, geomdata, ltransparm, *lprobparm);
-        });
-      estdt_tdif = amrex::min<amrex::Real>(estdt_tdif, dt);
+      amrex::ReduceOps<
+        amrex::ReduceOpMin, amrex::ReduceOpMin, amrex::ReduceOpMin,
+        amrex::ReduceOpMin>
+        reduce_op;
+      amrex::ReduceData<amrex::Real, amrex::Real, amrex::Real, amrex::Real>
+        reduce_data(reduce_op);
+      using ReduceTuple = typename decltype(reduce_data)::Type;
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+      for (amrex::MFIter mfi(stateMF, amrex::TilingIfNotGPU()); mfi.isValid();
+           ++mfi) {
+        const amrex::Box& bx = mfi.tilebox();
+        if (flags[mfi].getType(bx) == amrex::FabType::covered) {
+          continue;
+        }
+        auto const& sarr = stateMF.const_array(mfi);
+        auto const& flag_arr = flags.const_array(mfi);
+        reduce_op.eval(
+          bx, reduce_data,
+          [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept -> ReduceTuple {
+            amrex::Real dt[NumDtLimits];
+            if (flag_arr(i, j, k).isCovered()) {
+              for (amrex::Real& dtn : dt) {
+                dtn = std::numeric_limits<amrex::Real>::max();
+              }
+            } else {
+              pc_estdt_cell(
+                i, j, k, sarr, geomdata, which, ltransparm, *lprobparm, dt);
+            }
+            return {dt[DtHydro], dt[DtVelDif], dt[DtTempDif], dt[DtEnthDif]};
+          });
+      }
+      const auto dts = reduce_data.value(reduce_op);
+      estdt_limits[DtHydro] =
+        amrex::min<amrex::Real>(estdt_limits[DtHydro], amrex::get<0>(dts));
+      estdt_limits[DtVelDif] =
+        amrex::min<amrex::Real>(estdt_limits[DtVelDif], amrex::get<1>(dts));
+      estdt_limits[DtTempDif] =
+        amrex::min<amrex::Real>(estdt_limits[DtTempDif], amrex::get<2>(dts));
+      estdt_limits[DtEnthDif] =
+        amrex::min<amrex::Real>(estdt_limits[DtEnthDif], amrex::get<3>(dts));
     }
 
-    if (diffuse_enth) {
-      auto const& geomdata = geom.data();
-      auto const* ltransparm = trans_parms.device_parm();
-      const ProbParmDevice* lprobparm = PeleC::d_prob_parm_device;
-      amrex::Real dt = amrex::ReduceMin(
-        stateMF, flags, 0,
-        [=] AMREX_GPU_HOST_DEVICE(
-          amrex::Box const& bx, const amrex::Array4<const amrex::Real>& fab_arr,
-          const amrex::Array4<const amrex::EBCellFlag>& flag_arr)
-          -> amrex::Real {
-          return pc_estdt_enthdif(
-            bx, fab_arr, flag_arr, geomdata, ltransparm, *lprobparm);
-        });
-      estdt_edif = amrex::min<amrex::Real>(estdt_edif, dt);
+    amrex::ParallelDescriptor::ReduceRealMin(
+      estdt_limits.data(), NumDtLimits);
+
+    const amrex::Vector<std::string> limiter_names = {
+      "hydro", "viscous diffusion", "thermal diffusion", "enthalpy diffusion"};
+    int limit = DtHydro;
+    for (int n = 0; n < NumDtLimits; ++n) {
+      AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+        estdt_limits[n] > 0.0, "ERROR: dt needs to be positive.");
+      if (estdt_limits[n] < estdt_limits[limit]) {
+        limit = n;
+      }
     }
-
-    estdt_hydro = amrex::min<amrex::Real>(
-      estdt_hydro,
-      amrex::min<amrex::Real>(
-        estdt_vdif, amrex::min<amrex::Real>(estdt_tdif, estdt_edif)));
-
-    amrex::ParallelDescriptor::ReduceRealMin(estdt_hydro);
-    estdt_hydro *= cfl;
+    const amrex::Real estdt_hydro = cfl * estdt_limits[limit];
 
     if (verbose != 0) {
       amrex::Print() << "...estimated hydro-limited timestep at level " << level
-                     << ": " << estdt_hydro << std::endl;
+                     << ": " << estdt_hydro << " (" << limiter_names[limit]
+                     << (reuse_courno ? ", from the Courant number" : "")
+                     << ")" << std::endl;
     }
 
     // Determine if this is more restrictive than the maximum timestep limiting
     if (estdt_hydro < estdt) {
-      limiter = "hydro";
+      limiter = limiter_names[limit];
       estdt = estdt_hydro;
     }
   }
@@ -1192,14 +1218,10 @@ PeleC::post_timestep(int iteration)
         finest_level + 1);
       for (int lev = 0; lev <= finest_level; ++lev) {
         auto& amrlevel = parent->getLevel(lev);
-        amrex::MultiFab S_data(
-          amrlevel.get_new_data(State_Type).boxArray(),
-          amrlevel.get_new_data(State_Type).DistributionMap(), NVAR, 1,
-          amrex::MFInfo(), amrlevel.Factory());
-        amrex::MultiFab R_data(
-          amrlevel.get_new_data(Reactions_Type).boxArray(),
-          amrlevel.get_new_data(Reactions_Type).DistributionMap(),
-          NUM_SPECIES + 2, 1, amrex::MFInfo(), amrlevel.Factory());
+        auto& pc_level = dynamic_cast<PeleC&>(amrlevel);
+        pc_level.define_diag_workspace();
+        amrex::MultiFab& S_data = pc_level.diag_S_data;
+        amrex::MultiFab& R_data = pc_level.diag_R_data;
         FillPatch(
           amrlevel, S_data, S_data.nGrow(), cumtime, State_Type, Density, NVAR,
           0);
@@ -1207,14 +1229,25 @@ PeleC::post_timestep(int iteration)
           amrlevel, R_data, R_data.nGrow(), cumtime, Reactions_Type, 0,
           NUM_SPECIES + 2, 0);
 
-        diagMFVec[lev] = std::make_unique<amrex::MultiFab>(
-          amrlevel.boxArray(), amrlevel.DistributionMap(), m_diagVars.size(),
-          1);
+        // Derive all the records holding requested variables at once
+        amrex::Vector<std::string> derive_names;
+        amrex::Vector<int> derive_comp(m_diagVars.size(), -1);
+        int nderive = 0;
         for (int v{0}; v < m_diagVars.size(); ++v) {
-          // Already tested: either a derive or a state variable
           if (derive_lst.canDerive(m_diagVars[v])) {
-            auto mf = amrlevel.derive(m_diagVars[v], cumtime, 1);
             const amrex::DeriveRec* rec = derive_lst.get(m_diagVars[v]);
+            int offset = 0;
+            int d = 0;
+            for (; d < derive_names.size(); ++d) {
+              if (derive_names[d] == rec->name()) {
+                break;
+              }
+              offset += derive_lst.get(derive_names[d])->numDerive();
+            }
+            if (d == derive_names.size()) {
+              derive_names.push_back(rec->name());
+              nderive += rec->numDerive();
+            }
             int varIdx{0};
             for (int vd{0}; vd < rec->numDerive(); ++vd) {
               if (m_diagVars[v] == rec->variableName(vd)) {
@@ -1222,7 +1255,25 @@ PeleC::post_timestep(int iteration)
                 break;
               }
             }
-            amrex::MultiFab::Copy(*diagMFVec[lev], *mf, varIdx, v, 1, 1);
+            derive_comp[v] = offset + varIdx;
+          }
+        }
+        amrex::MultiFab derive_data;
+        if (nderive > 0) {
+          derive_data.define(
+            amrlevel.boxArray(), amrlevel.DistributionMap(), nderive, 1,
+            amrex::MFInfo(), amrlevel.Factory());
+          pc_level.deriveBatch(derive_names, cumtime, derive_data, 0, &S_data);
+        }
+
+        diagMFVec[lev] = std::make_unique<amrex::MultiFab>(
+          amrlevel.boxArray(), amrlevel.DistributionMap(), m_diagVars.size(),
+          1);
+        for (int v{0}; v < m_diagVars.size(); ++v) {
+          // Already tested: either a derive or a state variable
+          if (derive_comp[v] >= 0) {
+            amrex::MultiFab::Copy(
+              *diagMFVec[lev], derive_data, derive_comp[v], v, 1, 1);
           } else {
             int StIndex = 0;
             int scomp = 0;
@@ -1289,6 +1340,94 @@ PeleC::postCoarseTimeStep(amrex::Real cumtime)
 {
   BL_PROFILE("PeleC::postCoarseTimeStep()");
   AmrLevel::postCoarseTimeStep(cumtime);
+
+  if (level == 0) {
+    if (workspace_report_pending && (verbose != 0)) {
+      print_workspace_memory();
+    }
+    workspace_report_pending = false;
+  }
+}
+
+void
+PeleC::define_diag_workspace()
+{
+  const amrex::MultiFab& S_new = get_new_data(State_Type);
+  if (
+    (diag_S_data.boxArray() != S_new.boxArray()) ||
+    (diag_S_data.DistributionMap() != S_new.DistributionMap())) {
+    BL_PROFILE("PeleC::define_diag_workspace()");
+    diag_S_data.define(
+      S_new.boxArray(), S_new.DistributionMap(), NVAR, 1, amrex::MFInfo(),
+      Factory());
+    const amrex::MultiFab& R_new = get_new_data(Reactions_Type);
+    diag_R_data.define(
+      R_new.boxArray(), R_new.DistributionMap(), NUM_SPECIES + 2, 1,
+      amrex::MFInfo(), Factory());
+  }
+}
+
+void
+PeleC::clear_diag_workspace()
+{
+  diag_S_data.clear();
+  diag_R_data.clear();
+}
+
+void
+PeleC::print_workspace_memory()
+{
+  // Only the buffers allocated by the time of the call are listed
+  const int IOProc = amrex::ParallelDescriptor::IOProcessorNumber();
+  for (int lev = 0; lev <= parent->finestLevel(); ++lev) {
+    auto& pc_level = dynamic_cast<PeleC&>(parent->getLevel(lev));
+    amrex::Vector<std::string> names;
+    amrex::Vector<amrex::Long> bytes;
+    auto add = [&](const std::string& name, const auto& fa) {
+      names.push_back(name);
+      bytes.push_back(fa.nBytesOwned());
+    };
+    add("Sborder", pc_level.Sborder);
+    add("Sborder_Q", pc_level.Sborder_Q);
+    add("Sborder_Qaux", pc_level.Sborder_Qaux);
+    add("mol_src", pc_level.mol_src);
+    add("mol_src_old", pc_level.mol_src_old);
+    add("mol_src_new", pc_level.mol_src_new);
+    add("mol_Q", pc_level.mol_Q);
+    add("mol_Qaux", pc_level.mol_Qaux);
+    add("mol_coeffs", pc_level.mol_coeffs);
+    add("mol_xh", pc_level.mol_xh);
+    add("iter_S_prev", pc_level.iter_S_prev);
+    add("iter_R_prev", pc_level.iter_R_prev);
+    add("react_STemp", pc_level.react_STemp);
+    add("react_extsrc_rY", pc_level.react_extsrc_rY);
+    add("react_extsrc_rE", pc_level.react_extsrc_rE);
+    add("react_fctCount", pc_level.react_fctCount);
+    add("react_non_react_src", pc_level.react_non_react_src);
+    add("react_mask", pc_level.react_mask);
+    add("react_ids", pc_level.react_ids);
+    add("diag_S_data", pc_level.diag_S_data);
+    add("diag_R_data", pc_level.diag_R_data);
+
+    amrex::Vector<amrex::Long> bytes_max(bytes);
+    const int n = static_cast<int>(bytes.size());
+    amrex::ParallelDescriptor::ReduceLongSum(bytes.data(), n, IOProc);
+    amrex::ParallelDescriptor::ReduceLongMax(bytes_max.data(), n, IOProc);
+
+    if (amrex::ParallelDescriptor::IOProcessor()) {
+      amrex::Long total = 0;
+      amrex::Print() << "Persistent buffers of level " << lev
+                     << " (MB total, max per rank):" << std::endl;
+      for (int i = 0; i < n; ++i) {
+        if (bytes[i] > 0) {
+          amrex::Print() << "  " << names[i] << ": " << bytes[i] / 1.0e6
+                         << ", " << bytes_max[i] / 1.0e6 << std::endl;
+          total += bytes[i];
+        }
+      }
+      amrex::Print() << "  total: " << total / 1.0e6 << std::endl;
+    }
+  }
 }
 
 void
@@ -1296,6 +1435,10 @@ PeleC::post_regrid(int lbase, int /*new_finest*/)
 {
   BL_PROFILE("PeleC::post_regrid()");
   fine_mask.clear();
+  clear_react_workspace();
+  clear_mol_workspace();
+  clear_diag_workspace();
+  workspace_report_pending = true;
 
 #ifdef PELE_USE_SPRAY
   if (lbase == level) {
@@ -2038,6 +2181,12 @@ PeleC::init_reactor()
                    << std::endl;
   }
   reactor->init(1, 1);
+
+  if (react_cache && !chem_cache) {
+    chem_cache = std::make_unique<ChemCache>(
+      2 * NUM_SPECIES + 4, NUM_SPECIES + 1, NUM_SPECIES, NUM_SPECIES + 1,
+      react_cache_size, react_cache_tol);
+  }
 }
 
 void
@@ -1,9 +1,242 @@
+#include <cstdio>
+#include <fstream>
+
+#include <AMReX_Utility.H>
+#include <AMReX_VisMF.H>
+
 #include "PeleCAmr.H"
+#include "IO.H"
 
 #ifdef PELE_USE_SPRAY
 #include "SprayParticles.H"
 #endif
 
+void
+PeleCAmr::checkPoint()
+{
+  if (!PeleC::asyncCheckpoints()) {
+    amrex::Amr::checkPoint();
+    return;
+  }
+
+  if (!checkpoint_files_output) {
+    return;
+  }
+  BL_PROFILE("PeleCAmr::checkPoint()");
+
+  // The state is staged in a single buffer, the previous checkpoint must be
+  // on disk before it is reused
+  finalizeCheckPoint(true);
+  if (!checkpoint_writer) {
+    checkpoint_writer = std::make_unique<AsyncFileWriter>(1);
+  }
+
+  auto dCheckPointFileTime0 = amrex::second();
+
+  const std::string ckfile =
+    amrex::Concatenate(check_file_root, level_steps[0], file_name_digits);
+
+  if (verbose > 0) {
+    amrex::Print() << "CHECKPOINT: file = " << ckfile << '\n';
+  }
+
+  if ((record_run_info != 0) && amrex::ParallelDescriptor::IOProcessor()) {
+    runlog << "CHECKPOINT: file = " << ckfile << '\n';
+  }
+
+  // The checkpoint is written in ckfile.temp, which is renamed to ckfile by
+  // finalizeCheckPoint once all the data is on disk. Until then it holds a
+  // marker file so that restarting from it is rejected.
+  const std::string ckfileTemp(ckfile + ".temp");
+  const std::string levelPrefix = "Level_";
+  amrex::PreBuildDirectorHierarchy(
+    ckfileTemp, levelPrefix, finest_level + 1, true);
+
+  const amrex::FABio::Format prev_format = amrex::FArrayBox::getFormat();
+  amrex::FArrayBox::setFormat(amrex::FABio::FAB_NATIVE);
+
+  // Same header as Amr::checkPoint, the level headers are appended by
+  // PeleC::checkPointAsync
+  std::ofstream HeaderFile;
+  if (amrex::ParallelDescriptor::IOProcessor()) {
+    const std::string MarkerFileName(
+      ckfileTemp + "/" + checkpoint_pending_file);
+    std::ofstream MarkerFile(MarkerFileName.c_str(), std::ios::out);
+    if (!MarkerFile.good()) {
+      amrex::FileOpenFailed(MarkerFileName);
+    }
+    MarkerFile << "Checkpoint data is being written\n";
+
+    const std::string HeaderFileName(ckfileTemp + "/Header");
+    HeaderFile.open(
+      HeaderFileName.c_str(),
+      std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!HeaderFile.good()) {
+      amrex::FileOpenFailed(HeaderFileName);
+    }
+    HeaderFile.precision(17);
+    HeaderFile << "CheckPointVersion_1.0\n"
+               << AMREX_SPACEDIM << '\n'
+               << cumtime << '\n'
+               << max_level << '\n'
+               << finest_level << '\n';
+    for (int i = 0; i <= max_level; ++i) {
+      HeaderFile << geom[i] << ' ';
+    }
+    HeaderFile << '\n';
+    for (int i = 0; i < max_level; ++i) {
+      HeaderFile << ref_ratio[i] << ' ';
+    }
+    HeaderFile << '\n';
+    for (int i = 0; i <= max_level; ++i) {
+      HeaderFile << dt_level[i] << ' ';
+    }
+    HeaderFile << '\n';
+    for (int i = 0; i <= max_level; ++i) {
+      HeaderFile << dt_min[i] << ' ';
+    }
+    HeaderFile << '\n';
+    for (int i = 0; i <= max_level; ++i) {
+      HeaderFile << n_cycle[i] << ' ';
+    }
+    HeaderFile << '\n';
+    for (int i = 0; i <= max_level; ++i) {
+      HeaderFile << level_steps[i] << ' ';
+    }
+    HeaderFile << '\n';
+    for (int i = 0; i <= max_level; ++i) {
+      HeaderFile << level_count[i] << ' ';
+    }
+    HeaderFile << '\n';
+  }
+
+  std::vector<AsyncFileWriter::File> files;
+  amrex::Vector<std::string> fa_header_names;
+  for (int lev = 0; lev <= finest_level; ++lev) {
+    dynamic_cast<PeleC&>(*amr_level[lev])
+      .checkPointAsync(ckfileTemp, HeaderFile, files, fa_header_names);
+  }
+
+  if (amrex::ParallelDescriptor::IOProcessor()) {
+    if (!HeaderFile.good()) {
+      amrex::Abort("PeleCAmr::checkPoint() failed");
+    }
+    HeaderFile.close();
+
+    const std::string FAHeaderFilesName(ckfileTemp + "/FabArrayHeaders.txt");
+    std::ofstream FAHeaderFile(
+      FAHeaderFilesName.c_str(),
+      std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!FAHeaderFile.good()) {
+      amrex::FileOpenFailed(FAHeaderFilesName);
+    }
+    for (const auto& name : fa_header_names) {
+      FAHeaderFile << name << '\n';
+    }
+  }
+
+  amrex::FArrayBox::setFormat(prev_format);
+
+  checkpoint_writer->submit(std::move(files));
+  pending_checkpoint = ckfile;
+  last_checkpoint = level_steps[0];
+
+  if (verbose > 0) {
+    const int IOProc = amrex::ParallelDescriptor::IOProcessorNumber();
+    auto dCheckPointFileTime = amrex::second() - dCheckPointFileTime0;
+    amrex::ParallelDescriptor::ReduceRealMax(dCheckPointFileTime, IOProc);
+    amrex::Print() << "Write checkpoint time = " << dCheckPointFileTime
+                   << "  seconds (staged)\n\n";
+  }
+}
+
+void
+PeleCAmr::finalizeCheckPoint(const bool wait)
+{
+  if (pending_checkpoint.empty()) {
+    return;
+  }
+
+  if (!wait) {
+    bool written = (checkpoint_writer->pending() == 0);
+    amrex::ParallelDescriptor::ReduceBoolAnd(written);
+    if (!written) {
+      return;
+    }
+  }
+  BL_PROFILE("PeleCAmr::finalizeCheckPoint()");
+
+  // Aborts if this rank failed to write its data
+  checkpoint_writer->finish();
+  amrex::ParallelDescriptor::Barrier("PeleCAmr::finalizeCheckPoint");
+
+  if (amrex::ParallelDescriptor::IOProcessor()) {
+    // A checkpoint with the same name is only moved away now that the new
+    // one is complete
+    const std::string ckfileTemp(pending_checkpoint + ".temp");
+    std::remove((ckfileTemp + "/" + checkpoint_pending_file).c_str());
+    if (amrex::FileExists(pending_checkpoint)) {
+      amrex::UtilRenameDirectoryToOld(pending_checkpoint, false);
+    }
+    if (std::rename(ckfileTemp.c_str(), pending_checkpoint.c_str()) != 0) {
+      amrex::Abort("Failed to rename " + ckfileTemp);
+    }
+  }
+  amrex::ParallelDescriptor::Barrier("PeleCAmr::finalizeCheckPoint::rename");
+
+  if (verbose > 0) {
+    amrex::Print() << "CHECKPOINT: file = " << pending_checkpoint
+                   << " complete\n";
+  }
+  pending_checkpoint.clear();
+}
+
+void
+PeleCAmr::finalizePlotFiles(const bool wait)
+{
+  if (pending_plotfiles.empty()) {
+    return;
+  }
+
+  // The writer completes the plotfiles in order, so the first ndone ones
+  // are on disk on all the ranks
+  auto ndone = static_cast<int>(pending_plotfiles.size());
+  if (wait) {
+    // Aborts if this rank failed to write its data
+    plot_writer->finish();
+    amrex::ParallelDescriptor::Barrier("PeleCAmr::finalizePlotFiles");
+  } else {
+    ndone -= plot_writer->pending();
+    amrex::ParallelDescriptor::ReduceIntMin(ndone);
+    if (ndone == 0) {
+      return;
+    }
+  }
+  BL_PROFILE("PeleCAmr::finalizePlotFiles()");
+
+  if (amrex::ParallelDescriptor::IOProcessor()) {
+    for (int n = 0; n < ndone; ++n) {
+      const std::string& pltfile = pending_plotfiles[n];
+      const std::string pltfileTemp(pltfile + ".temp");
+      if (amrex::FileExists(pltfile)) {
+        amrex::UtilRenameDirectoryToOld(pltfile, false);
+      }
+      if (std::rename(pltfileTemp.c_str(), pltfile.c_str()) != 0) {
+        amrex::Abort("Failed to rename " + pltfileTemp);
+      }
+    }
+  }
+  amrex::ParallelDescriptor::Barrier("PeleCAmr::finalizePlotFiles::rename");
+
+  for (int n = 0; n < ndone; ++n) {
+    if (verbose > 0) {
+      amrex::Print() << "PLOTFILE: file = " << pending_plotfiles.front()
+                     << " complete\n";
+    }
+    pending_plotfiles.pop_front();
+  }
+}
+
 void
 PeleCAmr::writePlotFile()
 {
@@ -132,9 +365,15 @@ PeleCAmr::constructPlotMF(
   const int nlevels = finestLevel() + 1;
   for (int lev = 0; lev < nlevels; ++lev) {
 
-    plotMFs[lev] = std::make_unique<amrex::MultiFab>(
-      boxArray(lev), DistributionMap(lev), n_data_items, nGrow, amrex::MFInfo(),
-      amr_level[lev]->Factory());
+    // MultiFabs matching the grids and variables are refilled in place
+    if (
+      !plotMFs[lev] || (plotMFs[lev]->boxArray() != boxArray(lev)) ||
+      (plotMFs[lev]->DistributionMap() != DistributionMap(lev)) ||
+      (plotMFs[lev]->nComp() != n_data_items)) {
+      plotMFs[lev] = std::make_unique<amrex::MultiFab>(
+        boxArray(lev), DistributionMap(lev), n_data_items, nGrow,
+        amrex::MFInfo(), amr_level[lev]->Factory());
+    }
 
     // Cull data from state variables -- use no ghost cells.
     int cnt = 0;
@@ -146,15 +385,14 @@ PeleCAmr::constructPlotMF(
       cnt++;
     }
 
-    // Cull data from derived variables.
+    // Cull data from derived variables, all at once.
     if ((!derive_names.empty())) {
+      const amrex::Vector<std::string> derive_vec(
+        derive_names.begin(), derive_names.end());
+      dynamic_cast<PeleC&>(*amr_level[lev])
+        .deriveBatch(derive_vec, cur_time, *plotMFs[lev], cnt);
       for (const auto& derive_name : derive_names) {
-        const amrex::DeriveRec* rec = derive_lst.get(derive_name);
-        int ncomp = rec->numDerive();
-
-        auto derive_dat = amr_level[lev]->derive(derive_name, cur_time, nGrow);
-        amrex::MultiFab::Copy(*plotMFs[lev], *derive_dat, 0, cnt, ncomp, nGrow);
-        cnt += ncomp;
+        cnt += derive_lst.get(derive_name)->numDerive();
       }
     }
 
@@ -246,6 +484,11 @@ PeleCAmr::writePlotFileDoit(
     istep[lev] = levelSteps(lev);
   }
 
+  // Asynchronous plotfiles are written in pltfile.temp, which is renamed by
+  // finalizePlotFiles once the data is on disk
+  const bool async_plotfiles = PeleC::asyncPlotfiles() && !write_hdf5_plots;
+  const std::string pltdir = async_plotfiles ? pltfile + ".temp" : pltfile;
+
 #ifdef AMREX_USE_HDF5
   if (write_hdf5_plots) {
     amrex::WriteMultiLevelPlotfileHDF5SingleDset(
@@ -254,9 +497,14 @@ PeleCAmr::writePlotFileDoit(
   } else {
 #endif
     (void)hdf5_compression; // Avoid unused warning
-    amrex::WriteMultiLevelPlotfile(
-      pltfile, nlevels, plotMFs_constvec, plt_var_names, Geom(), cur_time,
-      istep, refRatio());
+    if (async_plotfiles) {
+      writeMultiLevelPlotfileAsync(
+        pltfile, plotMFs_constvec, plt_var_names, cur_time, istep);
+    } else {
+      amrex::WriteMultiLevelPlotfile(
+        pltfile, nlevels, plotMFs_constvec, plt_var_names, Geom(), cur_time,
+        istep, refRatio());
+    }
 #ifdef AMREX_USE_HDF5
   }
 #endif
@@ -267,7 +515,7 @@ PeleCAmr::writePlotFileDoit(
     HeaderFile.rdbuf()->pubsetbuf(io_buffer.dataPtr(), io_buffer.size());
     if (amrex::ParallelDescriptor::IOProcessor()) {
       // Only the IOProcessor() writes to the header file.
-      std::string HeaderFileName(pltfile + "/Header");
+      std::string HeaderFileName(pltdir + "/Header");
       HeaderFile.open(HeaderFileName.c_str(), std::ios::app | std::ios::binary);
       if (!HeaderFile.good()) {
         amrex::FileOpenFailed(HeaderFileName);
@@ -283,7 +531,7 @@ PeleCAmr::writePlotFileDoit(
 
   if (regular && !write_hdf5_plots) {
     for (int lev = 0; lev < nlevels; ++lev) {
-      amr_level[lev]->writePlotFilePost(pltfile, HeaderFile);
+      amr_level[lev]->writePlotFilePost(pltdir, HeaderFile);
     }
 
     last_plotfile = level_steps[0];
@@ -299,7 +547,7 @@ PeleCAmr::writePlotFileDoit(
   if (PeleC::SprayPC != nullptr) {
     if (regular) {
       for (int lev = 0; lev < nlevels; ++lev) {
-        PeleC::SprayPC->SprayParticleIO(lev, false, pltfile);
+        PeleC::SprayPC->SprayParticleIO(lev, false, pltdir);
       }
     } else {
       amrex::Abort("HDF5 particle writing incomplete");
@@ -313,15 +561,70 @@ PeleCAmr::writePlotFileDoit(
     amrex::ParallelDescriptor::ReduceRealMax(dPlotFileTime, IOProc);
     if (regular) {
       amrex::Print() << "Write plotfile time = " << dPlotFileTime << "  seconds"
-                     << "\n\n";
+                     << (async_plotfiles ? " (staged)" : "") << "\n\n";
     } else {
       amrex::Print() << "Write small plotfile time = " << dPlotFileTime
-                     << "  seconds"
+                     << "  seconds" << (async_plotfiles ? " (staged)" : "")
                      << "\n\n";
     }
   }
 }
 
+void
+PeleCAmr::writeMultiLevelPlotfileAsync(
+  const std::string& pltfile,
+  const amrex::Vector<const amrex::MultiFab*>& plotMFs,
+  const amrex::Vector<std::string>& plt_var_names,
+  const amrex::Real time,
+  const amrex::Vector<int>& istep)
+{
+  BL_PROFILE("PeleCAmr::writeMultiLevelPlotfileAsync()");
+
+  if (!plot_writer) {
+    plot_writer =
+      std::make_unique<AsyncFileWriter>(PeleC::asyncPlotfilesMaxPending());
+  }
+
+  const auto nlevels = static_cast<int>(plotMFs.size());
+  const std::string levelPrefix = "Level_";
+  const std::string mfPrefix = "Cell";
+  const std::string pltfileTemp(pltfile + ".temp");
+
+  // The directories and the headers are written synchronously
+  amrex::PreBuildDirectorHierarchy(pltfileTemp, levelPrefix, nlevels, true);
+  if (amrex::ParallelDescriptor::IOProcessor()) {
+    amrex::Vector<amrex::BoxArray> boxArrays(nlevels);
+    for (int lev = 0; lev < nlevels; ++lev) {
+      boxArrays[lev] = plotMFs[lev]->boxArray();
+    }
+    const std::string HeaderFileName(pltfileTemp + "/Header");
+    std::ofstream HeaderFile(
+      HeaderFileName.c_str(),
+      std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!HeaderFile.good()) {
+      amrex::FileOpenFailed(HeaderFileName);
+    }
+    amrex::WriteGenericPlotfileHeader(
+      HeaderFile, nlevels, boxArrays, plt_var_names, Geom(), time, istep,
+      refRatio(), "HyperCLaw-V1.1", levelPrefix, mfPrefix);
+  }
+
+  // Stage the data of each level in the layout of VisMF (one file per rank
+  // holding its FABs)
+  std::vector<AsyncFileWriter::File> files;
+  for (int lev = 0; lev < nlevels; ++lev) {
+    stage_multifab(
+      *plotMFs[lev],
+      amrex::MultiFabFileFullPrefix(lev, pltfileTemp, levelPrefix, mfPrefix),
+      files);
+  }
+
+  // Returns once the data is queued, or once an older plotfile is written
+  // when too many are pending
+  plot_writer->submit(std::move(files));
+  pending_plotfiles.push_back(pltfile);
+}
+
 #ifdef AMREX_USE_ASCENT
 void
 PeleCAmr::doInSituViz(const int step)
@@ -343,16 +646,21 @@ PeleCAmr::doInSituViz(const int step)
 
   auto dPlotFileTime0 = amrex::second();
 
+  // The plot MultiFabs are kept between calls and refilled in place, so the
+  // blueprint, whose fields point to their data, only has to be rebuilt
+  // when the grids change
   const int nlevels = finestLevel() + 1;
+  auto& plotMFs = pele_ascent.plot_mfs;
+  bool rebuild_mesh = !pele_ascent.mesh_built || (plotMFs.size() != nlevels);
+  plotMFs.resize(nlevels);
+  amrex::Vector<const amrex::MultiFab*> old_mfs(nlevels);
+  for (int lev = 0; lev < nlevels; ++lev) {
+    old_mfs[lev] = plotMFs[lev].get();
+  }
   amrex::Vector<std::string> plt_var_names;
-  amrex::Vector<std::unique_ptr<amrex::MultiFab>> plotMFs(nlevels);
   constructPlotMF(true, plotMFs, plt_var_names);
-
-  amrex::Vector<const amrex::MultiFab*> plotMFs_constvec;
-  plotMFs_constvec.reserve(nlevels);
   for (int lev = 0; lev < nlevels; ++lev) {
-    plotMFs_constvec.push_back(
-      static_cast<const amrex::MultiFab*>(plotMFs[lev].get()));
+    rebuild_mesh = rebuild_mesh || (plotMFs[lev].get() != old_mfs[lev]);
   }
 
   const amrex::Real cur_time =
@@ -362,31 +670,43 @@ PeleCAmr::doInSituViz(const int step)
     istep[lev] = levelSteps(lev);
   }
 
-  conduit::Node bp_mesh;
-  amrex::MultiLevelToBlueprint(
-    nlevels, plotMFs_constvec, plt_var_names, Geom(), cur_time, istep,
-    refRatio(), bp_mesh);
+  conduit::Node& bp_mesh = pele_ascent.bp_mesh;
+  if (rebuild_mesh) {
+    amrex::Vector<const amrex::MultiFab*> plotMFs_constvec;
+    plotMFs_constvec.reserve(nlevels);
+    for (int lev = 0; lev < nlevels; ++lev) {
+      plotMFs_constvec.push_back(
+        static_cast<const amrex::MultiFab*>(plotMFs[lev].get()));
+    }
 
-  ascent::Ascent ascent;
-  conduit::Node open_opts;
+    bp_mesh.reset();
+    amrex::MultiLevelToBlueprint(
+      nlevels, plotMFs_constvec, plt_var_names, Geom(), cur_time, istep,
+      refRatio(), bp_mesh);
 
-#ifdef AMREX_USE_MPI
-  open_opts["mpi_comm"] =
-    MPI_Comm_c2f(amrex::ParallelDescriptor::Communicator());
-#endif
-  ascent.open(open_opts);
-  conduit::Node verify_info;
-  if (!conduit::blueprint::mesh::verify(bp_mesh, verify_info)) {
-    ASCENT_INFO("Error: Mesh Blueprint Verify Failed!");
-    verify_info.print();
+    conduit::Node verify_info;
+    if (!conduit::blueprint::mesh::verify(bp_mesh, verify_info)) {
+      ASCENT_INFO("Error: Mesh Blueprint Verify Failed!");
+      verify_info.print();
+    }
+    pele_ascent.mesh_built = true;
+  } else {
+    // Only the state of the domains changes
+    for (conduit::index_t d = 0; d < bp_mesh.number_of_children(); ++d) {
+      conduit::Node& domain = bp_mesh.child(d);
+      domain["state/time"] = cur_time;
+      const int lev = domain.has_path("state/level")
+                        ? domain["state/level"].to_int()
+                        : 0;
+      domain["state/cycle"] = istep[lev];
+    }
   }
 
-  conduit::Node actions;
-  ascent.publish(bp_mesh);
-
-  ascent.execute(actions);
+  pele_ascent.open();
+  pele_ascent.session.publish(bp_mesh);
 
-  ascent.close();
+  conduit::Node actions;
+  pele_ascent.session.execute(actions);
 
   if (verbose > 0) {
     const int IOProc = amrex::ParallelDescriptor::IOProcessorNumber();
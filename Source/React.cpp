@@ -1,9 +1,25 @@
+#include <cmath>
+
 #include <AMReX_FArrayBox.H>
+#include <AMReX_Scan.H>
 
 #include "IndexDefines.H"
 #include "PelePhysics.H"
 #include "PeleC.H"
 
+// Bin of a cell given the number of chemistry steps predicted over dt
+AMREX_GPU_DEVICE
+AMREX_FORCE_INLINE
+int
+stiffness_bin(const amrex::Real h, const amrex::Real dt, const int nbins)
+{
+  if ((nbins < 2) || (h <= 0.0)) {
+    return 0;
+  }
+  const amrex::Real nsteps = amrex::max<amrex::Real>(dt / h, 1.0);
+  return amrex::min(nbins - 1, static_cast<int>(std::log2(nsteps)));
+}
+
 void
 PeleC::set_typical_values_chem()
 {
@@ -26,6 +42,637 @@ PeleC::set_typical_values_chem()
   }
 }
 
+void
+PeleC::define_react_workspace(const int ng, const bool need_non_react_src)
+{
+  // The level grids are fixed for the lifetime of the level, so the workspace
+  // only needs to be allocated once (and again after post_regrid clears it)
+  if (
+    (react_STemp.boxArray() != grids) ||
+    (react_STemp.DistributionMap() != dmap) || (react_STemp.nGrow() != ng)) {
+    BL_PROFILE("PeleC::define_react_workspace()");
+    react_STemp.define(grids, dmap, NUM_SPECIES + 2, ng);
+    react_extsrc_rY.define(grids, dmap, NUM_SPECIES, ng);
+    react_extsrc_rE.define(grids, dmap, 1, ng);
+    react_fctCount.define(grids, dmap, 1, ng);
+    react_mask.define(grids, dmap, 1, ng);
+    if (react_batch_size != 0) {
+      react_ids.define(grids, dmap, 1, ng);
+    }
+  }
+
+  if (
+    need_non_react_src && ((react_non_react_src.boxArray() != grids) ||
+                           (react_non_react_src.DistributionMap() != dmap))) {
+    react_non_react_src.define(
+      grids, dmap, NVAR, get_new_data(State_Type).nGrow(), amrex::MFInfo(),
+      Factory());
+  }
+}
+
+void
+PeleC::clear_react_workspace()
+{
+  react_STemp.clear();
+  react_extsrc_rY.clear();
+  react_extsrc_rE.clear();
+  react_fctCount.clear();
+  react_non_react_src.clear();
+  react_mask.clear();
+  react_ids.clear();
+}
+
+void
+PeleC::build_react_mask(
+  const amrex::MultiFab& S,
+  const amrex::MultiFab& I_R,
+  amrex::iMultiFab& mask,
+  const int ng,
+  const bool react_init)
+{
+  BL_PROFILE("PeleC::build_react_mask()");
+
+  if (!react_active_cells) {
+    mask.setVal(1);
+    return;
+  }
+
+  int fuel_idx = -1;
+  if (react_active_fuel >= 0.0) {
+    fuel_idx = find_position(spec_names, fuel_name);
+    if (fuel_idx < 0) {
+      amrex::Abort("pelec.react_active_fuel requires a valid pelec.fuel_name");
+    }
+  }
+
+  // The heat release of the previous step is not available at initialization
+  const bool use_fuel = (fuel_idx >= 0);
+  const bool use_hr = (react_active_heat_release >= 0.0) && !react_init;
+  const amrex::Real temp_min = react_active_temp;
+  const amrex::Real fuel_min = react_active_fuel;
+  const amrex::Real hr_min = react_active_heat_release;
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+  for (amrex::MFIter mfi(mask, amrex::TilingIfNotGPU()); mfi.isValid();
+       ++mfi) {
+    const amrex::Box& gbx = mfi.growntilebox(ng);
+    const amrex::Box& vbx = mfi.validbox();
+    auto const& sarr = S.const_array(mfi);
+    auto const& rarr = I_R.const_array(mfi);
+    auto const& marr = mask.array(mfi);
+    amrex::ParallelFor(
+      gbx, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
+        bool active = sarr(i, j, k, UTEMP) >= temp_min;
+        if (active && (use_fuel || use_hr)) {
+          // I_R has no ghost cells, ghost cells are assumed to be active
+          // with respect to the heat release criterion
+          const bool has_hr =
+            use_hr && vbx.contains(amrex::IntVect(AMREX_D_DECL(i, j, k)));
+          const bool fuel_test =
+            use_fuel &&
+            (sarr(i, j, k, UFS + fuel_idx) >= fuel_min * sarr(i, j, k, URHO));
+          const bool hr_test =
+            has_hr && (std::abs(rarr(i, j, k, NUM_SPECIES + 1)) >= hr_min);
+          active = fuel_test || hr_test || (use_hr && !has_hr);
+        }
+        marr(i, j, k) = active ? 1 : 0;
+      });
+  }
+}
+
+void
+PeleC::react_active_tile(
+  const amrex::Box& bx,
+  amrex::Array4<amrex::Real> const& rhoY,
+  amrex::Array4<amrex::Real> const& frcExt,
+  amrex::Array4<amrex::Real> const& T,
+  amrex::Array4<amrex::Real> const& rhoE,
+  amrex::Array4<amrex::Real> const& frcEExt,
+  amrex::Array4<amrex::Real> const& fc,
+  amrex::Array4<int> const& mask,
+  amrex::Real dt,
+  amrex::Real& time)
+{
+  BL_PROFILE("PeleC::react_active_tile()");
+
+  // Inert cells only receive the non-reacting forcing
+  amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
+    if (mask(i, j, k) == 0) {
+      for (int n = 0; n < NUM_SPECIES; n++) {
+        rhoY(i, j, k, n) += dt * frcExt(i, j, k, n);
+      }
+      rhoE(i, j, k) += dt * frcEExt(i, j, k);
+      fc(i, j, k) = 0.0;
+    }
+  });
+
+  react_masked_tile(bx, rhoY, frcExt, T, rhoE, frcEExt, fc, mask, dt, time);
+}
+
+void
+PeleC::react_masked_tile(
+  const amrex::Box& bx,
+  amrex::Array4<amrex::Real> const& rhoY,
+  amrex::Array4<amrex::Real> const& frcExt,
+  amrex::Array4<amrex::Real> const& T,
+  amrex::Array4<amrex::Real> const& rhoE,
+  amrex::Array4<amrex::Real> const& frcEExt,
+  amrex::Array4<amrex::Real> const& fc,
+  amrex::Array4<int> const& mask,
+  amrex::Real dt,
+  amrex::Real& time)
+{
+  BL_PROFILE("PeleC::react_masked_tile()");
+
+  // Position of each active cell in the compacted list
+  const auto npts = static_cast<int>(bx.numPts());
+  amrex::Gpu::DeviceVector<int> cell_ids(npts);
+  int* p_ids = cell_ids.data();
+  const int nactive = amrex::Scan::PrefixSum<int>(
+    npts,
+    [=] AMREX_GPU_DEVICE(int n) -> int { return mask(bx.atOffset(n)); },
+    [=] AMREX_GPU_DEVICE(int n, int const& x) { p_ids[n] = x; },
+    amrex::Scan::Type::exclusive, amrex::Scan::retSum);
+
+  if (nactive == 0) {
+    return;
+  }
+
+  if (nactive == npts) {
+    reactor->react(
+      bx, rhoY, frcExt, T, rhoE, frcEExt, fc, mask, dt, time
+#ifdef AMREX_USE_GPU
+      ,
+      amrex::Gpu::gpuStream()
+#endif
+    );
+    return;
+  }
+
+  // Gather the active cells into a contiguous 1D box
+  const amrex::Box cbx(
+    amrex::IntVect(0), amrex::IntVect(AMREX_D_DECL(nactive - 1, 0, 0)));
+  amrex::FArrayBox cdata(cbx, 2 * NUM_SPECIES + 4, amrex::The_Async_Arena());
+  amrex::IArrayBox cmask(cbx, 1, amrex::The_Async_Arena());
+  cmask.setVal<amrex::RunOn::Device>(1);
+  auto const& c_rhoY = cdata.array(0);
+  auto const& c_frcExt = cdata.array(NUM_SPECIES);
+  auto const& c_T = cdata.array(2 * NUM_SPECIES);
+  auto const& c_rhoE = cdata.array(2 * NUM_SPECIES + 1);
+  auto const& c_frcEExt = cdata.array(2 * NUM_SPECIES + 2);
+  auto const& c_fc = cdata.array(2 * NUM_SPECIES + 3);
+  auto const& c_mask = cmask.array();
+
+  amrex::ParallelFor(npts, [=] AMREX_GPU_DEVICE(int n) noexcept {
+    const amrex::IntVect iv = bx.atOffset(n);
+    if (mask(iv) != 0) {
+      const amrex::IntVect civ(AMREX_D_DECL(p_ids[n], 0, 0));
+      for (int nsp = 0; nsp < NUM_SPECIES; nsp++) {
+        c_rhoY(civ, nsp) = rhoY(iv, nsp);
+        c_frcExt(civ, nsp) = frcExt(iv, nsp);
+      }
+      c_T(civ) = T(iv);
+      c_rhoE(civ) = rhoE(iv);
+      c_frcEExt(civ) = frcEExt(iv);
+    }
+  });
+
+  reactor->react(
+    cbx, c_rhoY, c_frcExt, c_T, c_rhoE, c_frcEExt, c_fc, c_mask, dt, time
+#ifdef AMREX_USE_GPU
+    ,
+    amrex::Gpu::gpuStream()
+#endif
+  );
+
+  // Scatter the integrated states back
+  amrex::ParallelFor(npts, [=] AMREX_GPU_DEVICE(int n) noexcept {
+    const amrex::IntVect iv = bx.atOffset(n);
+    if (mask(iv) != 0) {
+      const amrex::IntVect civ(AMREX_D_DECL(p_ids[n], 0, 0));
+      for (int nsp = 0; nsp < NUM_SPECIES; nsp++) {
+        rhoY(iv, nsp) = c_rhoY(civ, nsp);
+      }
+      T(iv) = c_T(civ);
+      rhoE(iv) = c_rhoE(civ);
+      fc(iv) = c_fc(civ);
+    }
+  });
+  amrex::Gpu::Device::streamSynchronize();
+}
+
+void
+PeleC::react_cached_tile(
+  const amrex::Box& bx,
+  amrex::Array4<amrex::Real> const& rhoY,
+  amrex::Array4<amrex::Real> const& frcExt,
+  amrex::Array4<amrex::Real> const& T,
+  amrex::Array4<amrex::Real> const& rhoE,
+  amrex::Array4<amrex::Real> const& frcEExt,
+  amrex::Array4<amrex::Real> const& fc,
+  amrex::Array4<int> const& mask,
+  amrex::Real dt,
+  amrex::Real& time)
+{
+  BL_PROFILE("PeleC::react_cached_tile()");
+
+  // The query is (Y, log(T), log(rho), forcing of Y and of T over dt,
+  // log(dt)) and the result is the change of rhoY/rho. The temperature
+  // follows from the energy, so it is consistent with the retrieved state.
+  constexpr int nkey = 2 * NUM_SPECIES + 4;
+  constexpr int nval = NUM_SPECIES;
+  const auto npts = static_cast<int>(bx.numPts());
+  amrex::Vector<amrex::Real> keys(static_cast<size_t>(npts) * nkey);
+  amrex::Vector<amrex::Real> vals(static_cast<size_t>(npts) * nval);
+  amrex::Vector<int> nearest(npts, -1);
+  amrex::IArrayBox miss(bx, 1);
+  auto const& marr = miss.array();
+  auto eos = pele::physics::PhysicsType::eos();
+
+  // Build the queries, the cache is not needed for this
+  amrex::LoopOnCpu(bx, [&](int i, int j, int k) noexcept {
+    marr(i, j, k) = 0;
+    if (mask(i, j, k) == 0) {
+      // Inert cells only receive the non-reacting forcing
+      for (int n = 0; n < NUM_SPECIES; n++) {
+        rhoY(i, j, k, n) += dt * frcExt(i, j, k, n);
+      }
+      rhoE(i, j, k) += dt * frcEExt(i, j, k);
+      fc(i, j, k) = 0.0;
+      return;
+    }
+
+    const auto n =
+      static_cast<int>(bx.index(amrex::IntVect(AMREX_D_DECL(i, j, k))));
+    amrex::Real* key = &keys[static_cast<size_t>(n) * nkey];
+    amrex::Real rho = 0.0;
+    for (int nsp = 0; nsp < NUM_SPECIES; nsp++) {
+      rho += rhoY(i, j, k, nsp);
+    }
+    const amrex::Real rhoInv = 1.0 / rho;
+    for (int nsp = 0; nsp < NUM_SPECIES; nsp++) {
+      key[nsp] = rhoY(i, j, k, nsp) * rhoInv;
+      key[NUM_SPECIES + 2 + nsp] = dt * frcExt(i, j, k, nsp) * rhoInv;
+    }
+    amrex::Real cv = 0.0;
+    eos.RTY2Cv(rho, T(i, j, k), key, cv);
+    key[NUM_SPECIES] = std::log(T(i, j, k));
+    key[NUM_SPECIES + 1] = std::log(rho);
+    key[2 * NUM_SPECIES + 2] =
+      dt * frcEExt(i, j, k) * rhoInv / (cv * T(i, j, k));
+    key[2 * NUM_SPECIES + 3] = std::log(dt);
+  });
+
+  // Look up the queries. The results are copied since the entries may be
+  // evicted by other threads once the lock is released.
+  {
+    std::lock_guard<std::mutex> lock(chem_cache->mutex());
+    amrex::LoopOnCpu(bx, [&](int i, int j, int k) noexcept {
+      if (mask(i, j, k) == 0) {
+        return;
+      }
+      const auto n =
+        static_cast<int>(bx.index(amrex::IntVect(AMREX_D_DECL(i, j, k))));
+      const int id =
+        chem_cache->find(&keys[static_cast<size_t>(n) * nkey], nearest[n]);
+      if (id < 0) {
+        marr(i, j, k) = 1;
+        return;
+      }
+      chem_cache->retrieve(
+        &keys[static_cast<size_t>(n) * nkey], id,
+        &vals[static_cast<size_t>(n) * nval]);
+    });
+  }
+
+  // Apply the retrieved results. Chemistry conserves the internal energy,
+  // so only the forcing changes rhoE, and T is recomputed from it.
+  amrex::LoopOnCpu(bx, [&](int i, int j, int k) noexcept {
+    if ((mask(i, j, k) == 0) || (marr(i, j, k) != 0)) {
+      return;
+    }
+    const auto n =
+      static_cast<int>(bx.index(amrex::IntVect(AMREX_D_DECL(i, j, k))));
+    const amrex::Real* key = &keys[static_cast<size_t>(n) * nkey];
+    const amrex::Real* val = &vals[static_cast<size_t>(n) * nval];
+    const amrex::Real rho = std::exp(key[NUM_SPECIES + 1]);
+    amrex::Real rho_new = 0.0;
+    for (int nsp = 0; nsp < NUM_SPECIES; nsp++) {
+      rhoY(i, j, k, nsp) += rho * val[nsp];
+      rho_new += rhoY(i, j, k, nsp);
+    }
+    rhoE(i, j, k) += dt * frcEExt(i, j, k);
+    amrex::Real massfrac[NUM_SPECIES] = {0.0};
+    for (int nsp = 0; nsp < NUM_SPECIES; nsp++) {
+      massfrac[nsp] = rhoY(i, j, k, nsp) / rho_new;
+    }
+    amrex::Real temp = T(i, j, k);
+    eos.REY2T(rho_new, rhoE(i, j, k) / rho_new, massfrac, temp);
+    T(i, j, k) = temp;
+    fc(i, j, k) = 0.0;
+  });
+
+  react_masked_tile(bx, rhoY, frcExt, T, rhoE, frcEExt, fc, marr, dt, time);
+
+  // Tabulate the directly integrated cells
+  amrex::LoopOnCpu(bx, [&](int i, int j, int k) noexcept {
+    if (marr(i, j, k) == 0) {
+      return;
+    }
+    const auto n =
+      static_cast<int>(bx.index(amrex::IntVect(AMREX_D_DECL(i, j, k))));
+    const amrex::Real* key = &keys[static_cast<size_t>(n) * nkey];
+    amrex::Real* val = &vals[static_cast<size_t>(n) * nval];
+    const amrex::Real rho = std::exp(key[NUM_SPECIES + 1]);
+    for (int nsp = 0; nsp < NUM_SPECIES; nsp++) {
+      val[nsp] = rhoY(i, j, k, nsp) / rho - key[nsp];
+    }
+  });
+
+  std::lock_guard<std::mutex> lock(chem_cache->mutex());
+  amrex::LoopOnCpu(bx, [&](int i, int j, int k) noexcept {
+    if (marr(i, j, k) == 0) {
+      return;
+    }
+    const auto n =
+      static_cast<int>(bx.index(amrex::IntVect(AMREX_D_DECL(i, j, k))));
+    chem_cache->update(
+      &keys[static_cast<size_t>(n) * nkey],
+      &vals[static_cast<size_t>(n) * nval], nearest[n]);
+  });
+}
+
+void
+PeleC::react_batched(
+  amrex::MultiFab& STemp,
+  amrex::MultiFab& extsrc_rY,
+  amrex::MultiFab& extsrc_rE,
+  amrex::MultiFab& fctCount,
+  const amrex::iMultiFab& mask,
+  const amrex::MultiFab* chem_dt,
+  const int ng,
+  const amrex::Real dt)
+{
+  BL_PROFILE("PeleC::react_batched()");
+
+  auto const& fact = dynamic_cast<amrex::EBFArrayBoxFactory const&>(Factory());
+  auto const& flags = fact.getMultiEBCellFlagFab();
+
+  // Position of the active cells of the local tiles in the batch buffer. The
+  // tiles are visited serially so that the positions are contiguous. With
+  // the chemistry step estimate, the cells are instead counted in bins of
+  // the (log2 of the) number of steps it predicts over dt, and placed by
+  // bin so that each batch holds cells of similar stiffness. The order
+  // within a bin is not deterministic on GPUs.
+  const bool sort_by_cost = (chem_dt != nullptr);
+  const int nbins = sort_by_cost ? 16 : 1;
+  amrex::Gpu::DeviceVector<int> bin_pos(nbins, 0);
+  int* p_bin_pos = bin_pos.data();
+  int nactive = 0;
+  for (amrex::MFIter mfi(STemp, amrex::TilingIfNotGPU()); mfi.isValid();
+       ++mfi) {
+    const amrex::Box& bx = mfi.growntilebox(ng);
+    const amrex::FabType typ = flags[mfi].getType(bx);
+    react_ids[mfi].setVal<amrex::RunOn::Device>(-1, bx);
+    if (
+      (typ != amrex::FabType::singlevalued) &&
+      (typ != amrex::FabType::regular)) {
+      continue;
+    }
+
+    auto const& m = mask.const_array(mfi);
+    auto const& ids = react_ids.array(mfi);
+    if (sort_by_cost) {
+      // Count the active cells of each bin, keeping the bin in the ids
+      auto const& hc = chem_dt->const_array(mfi);
+      amrex::ParallelFor(
+        bx, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
+          if (m(i, j, k) != 0) {
+            const amrex::IntVect iv(AMREX_D_DECL(i, j, k));
+            const int b =
+              hc.contains(iv) ? stiffness_bin(hc(iv), dt, nbins) : 0;
+            ids(iv) = b;
+            amrex::Gpu::Atomic::AddNoRet(p_bin_pos + b, 1);
+          }
+        });
+    } else {
+      const auto npts = static_cast<int>(bx.numPts());
+      const int offset = nactive;
+      nactive += amrex::Scan::PrefixSum<int>(
+        npts,
+        [=] AMREX_GPU_DEVICE(int n) -> int { return m(bx.atOffset(n)); },
+        [=] AMREX_GPU_DEVICE(int n, int const& x) {
+          const amrex::IntVect iv = bx.atOffset(n);
+          ids(iv) = (m(iv) != 0) ? offset + x : -1;
+        },
+        amrex::Scan::Type::exclusive, amrex::Scan::retSum);
+    }
+
+    // Inert cells only receive the non-reacting forcing
+    auto const& rhoY = STemp.array(mfi);
+    auto const& rhoE = STemp.array(mfi, NUM_SPECIES + 1);
+    auto const& frcExt = extsrc_rY.const_array(mfi);
+    auto const& frcEExt = extsrc_rE.const_array(mfi);
+    auto const& fc = fctCount.array(mfi);
+    amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
+      if (m(i, j, k) == 0) {
+        for (int n = 0; n < NUM_SPECIES; n++) {
+          rhoY(i, j, k, n) += dt * frcExt(i, j, k, n);
+        }
+        rhoE(i, j, k) += dt * frcEExt(i, j, k);
+        fc(i, j, k) = 0.0;
+      }
+    });
+  }
+
+  if (sort_by_cost) {
+    // Start of each bin in the batch buffer
+    amrex::Vector<int> h_bin_pos(nbins);
+    amrex::Gpu::copy(
+      amrex::Gpu::deviceToHost, bin_pos.begin(), bin_pos.end(),
+      h_bin_pos.begin());
+    for (int b = 0; b < nbins; b++) {
+      const int count = h_bin_pos[b];
+      h_bin_pos[b] = nactive;
+      nactive += count;
+    }
+    amrex::Gpu::copy(
+      amrex::Gpu::hostToDevice, h_bin_pos.begin(), h_bin_pos.end(),
+      bin_pos.begin());
+
+    for (amrex::MFIter mfi(STemp, amrex::TilingIfNotGPU()); mfi.isValid();
+         ++mfi) {
+      const amrex::Box& bx = mfi.growntilebox(ng);
+      auto const& ids = react_ids.array(mfi);
+      amrex::ParallelFor(
+        bx, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
+          const int b = ids(i, j, k);
+          if (b >= 0) {
+            ids(i, j, k) = amrex::Gpu::Atomic::Add(p_bin_pos + b, 1);
+          }
+        });
+    }
+  }
+
+  if (nactive == 0) {
+    return;
+  }
+
+  // Gather the active cells into a contiguous 1D box
+  const amrex::Box cbx(
+    amrex::IntVect(0), amrex::IntVect(AMREX_D_DECL(nactive - 1, 0, 0)));
+  amrex::FArrayBox cdata(cbx, 2 * NUM_SPECIES + 5, amrex::The_Async_Arena());
+  amrex::IArrayBox cmask(cbx, 1, amrex::The_Async_Arena());
+  cmask.setVal<amrex::RunOn::Device>(1);
+  const int fc_comp = 2 * NUM_SPECIES + 3;
+  auto const& c_rhoY = cdata.array(0);
+  auto const& c_frcExt = cdata.array(NUM_SPECIES);
+  auto const& c_T = cdata.array(2 * NUM_SPECIES);
+  auto const& c_rhoE = cdata.array(2 * NUM_SPECIES + 1);
+  auto const& c_frcEExt = cdata.array(2 * NUM_SPECIES + 2);
+  auto const& c_fc = cdata.array(fc_comp);
+  auto const& c_cost = cdata.array(2 * NUM_SPECIES + 4);
+  auto const& c_mask = cmask.array();
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+  for (amrex::MFIter mfi(STemp, amrex::TilingIfNotGPU()); mfi.isValid();
+       ++mfi) {
+    const amrex::Box& bx = mfi.growntilebox(ng);
+    auto const& rhoY = STemp.const_array(mfi);
+    auto const& T = STemp.const_array(mfi, NUM_SPECIES);
+    auto const& rhoE = STemp.const_array(mfi, NUM_SPECIES + 1);
+    auto const& frcExt = extsrc_rY.const_array(mfi);
+    auto const& frcEExt = extsrc_rE.const_array(mfi);
+    auto const& ids = react_ids.const_array(mfi);
+    amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
+      const int n = ids(i, j, k);
+      if (n >= 0) {
+        const amrex::IntVect civ(AMREX_D_DECL(n, 0, 0));
+        for (int nsp = 0; nsp < NUM_SPECIES; nsp++) {
+          c_rhoY(civ, nsp) = rhoY(i, j, k, nsp);
+          c_frcExt(civ, nsp) = frcExt(i, j, k, nsp);
+        }
+        c_T(civ) = T(i, j, k);
+        c_rhoE(civ) = rhoE(i, j, k);
+        c_frcEExt(civ) = frcEExt(i, j, k);
+        c_cost(civ) = 0.0;
+      }
+    });
+  }
+
+  // Integrate the batches
+  const int batch_size = (react_batch_size > 0) ? react_batch_size : nactive;
+  const int nbatch = (nactive + batch_size - 1) / batch_size;
+  const amrex::Real fc_weight = react_work_estimate_fc_weight;
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel for schedule(dynamic) if (amrex::Gpu::notInLaunchRegion())
+#endif
+  for (int ib = 0; ib < nbatch; ib++) {
+    const int lo = ib * batch_size;
+    const int hi = amrex::min(nactive, lo + batch_size) - 1;
+    const amrex::Box bbx(
+      amrex::IntVect(AMREX_D_DECL(lo, 0, 0)),
+      amrex::IntVect(AMREX_D_DECL(hi, 0, 0)));
+
+    amrex::Real wt = amrex::ParallelDescriptor::second(); // timing for batch
+    amrex::Real current_time = 0.0;
+
+    reactor->react(
+      bbx, c_rhoY, c_frcExt, c_T, c_rhoE, c_frcEExt, c_fc, c_mask, dt,
+      current_time
+#ifdef AMREX_USE_GPU
+      ,
+      amrex::Gpu::gpuStream()
+#endif
+    );
+    amrex::Gpu::Device::streamSynchronize();
+
+    wt = amrex::ParallelDescriptor::second() - wt;
+
+    if (do_react_load_balance) {
+      // Distribute the batch wall time according to the per-cell number of
+      // RHS evaluations of the reactor
+      const amrex::Real fc_sum = cdata.sum<amrex::RunOn::Device>(bbx, fc_comp);
+      const amrex::Real w_fc = (fc_sum > 0.0) ? fc_weight : 0.0;
+      const amrex::Real wt_cell = (1.0 - w_fc) * wt / bbx.d_numPts();
+      const amrex::Real wt_fc = (fc_sum > 0.0) ? w_fc * wt / fc_sum : 0.0;
+      amrex::ParallelFor(
+        bbx, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
+          c_cost(i, j, k) = wt_cell + wt_fc * c_fc(i, j, k);
+        });
+    }
+  }
+
+  // Scatter the integrated states back
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+  for (amrex::MFIter mfi(STemp, amrex::TilingIfNotGPU()); mfi.isValid();
+       ++mfi) {
+    const amrex::Box& bx = mfi.growntilebox(ng);
+    auto const& rhoY = STemp.array(mfi);
+    auto const& T = STemp.array(mfi, NUM_SPECIES);
+    auto const& rhoE = STemp.array(mfi, NUM_SPECIES + 1);
+    auto const& fc = fctCount.array(mfi);
+    auto const& ids = react_ids.const_array(mfi);
+    const bool add_cost = do_react_load_balance;
+    amrex::Array4<amrex::Real> west;
+    amrex::Real cost_scale = 1.0;
+    amrex::Real cost_uniform = 0.0;
+    if (add_cost) {
+      west = get_new_data(Work_Estimate_Type).array(mfi);
+      // As in the per-tile integration, the cost of the ghost cells is
+      // charged to the valid cells of the tile, in proportion to their own
+      // cost (uniformly when they have none)
+      const amrex::Box vbox = mfi.tilebox();
+      amrex::ReduceOps<amrex::ReduceOpSum, amrex::ReduceOpSum> reduce_op;
+      amrex::ReduceData<amrex::Real, amrex::Real> reduce_data(reduce_op);
+      using ReduceTuple = typename decltype(reduce_data)::Type;
+      reduce_op.eval(
+        bx, reduce_data,
+        [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept -> ReduceTuple {
+          const int n = ids(i, j, k);
+          if (n < 0) {
+            return {0.0, 0.0};
+          }
+          const amrex::Real c = c_cost(amrex::IntVect(AMREX_D_DECL(n, 0, 0)));
+          return {c, vbox.contains(i, j, k) ? c : 0.0};
+        });
+      const auto costs = reduce_data.value(reduce_op);
+      const amrex::Real cost_tile = amrex::get<0>(costs);
+      const amrex::Real cost_valid = amrex::get<1>(costs);
+      if (cost_valid > 0.0) {
+        cost_scale = cost_tile / cost_valid;
+      } else {
+        cost_scale = 0.0;
+        cost_uniform = cost_tile / vbox.d_numPts();
+      }
+    }
+    amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
+      const int n = ids(i, j, k);
+      const amrex::IntVect civ(AMREX_D_DECL(amrex::max(n, 0), 0, 0));
+      if (add_cost && west.contains(i, j, k)) {
+        west(i, j, k) +=
+          cost_uniform + ((n >= 0) ? cost_scale * c_cost(civ) : 0.0);
+      }
+      if (n >= 0) {
+        for (int nsp = 0; nsp < NUM_SPECIES; nsp++) {
+          rhoY(i, j, k, nsp) = c_rhoY(civ, nsp);
+        }
+        T(i, j, k) = c_T(civ);
+        rhoE(i, j, k) = c_rhoE(civ);
+        fc(i, j, k) = c_fc(civ);
+      }
+    });
+  }
+  amrex::Gpu::Device::streamSynchronize();
+}
+
 void
 PeleC::react_state(
   amrex::Real /*time*/,
@@ -52,34 +699,37 @@ PeleC::react_state(
   amrex::MultiFab& S_new = get_new_data(State_Type);
   const int ng = S_new.nGrow();
 
+  // The chemistry is integrated either on the grown boxes or on the valid
+  // boxes only, in which case the ghost cells are filled by communication
+  const int ng_react = react_valid_only ? 0 : ng;
+
+  // Reuse the level workspace for the non-reacting sources and the
+  // reactor data
+  const bool need_non_react_src = react_init || (aux_src == nullptr);
+  define_react_workspace(ng_react, need_non_react_src);
+
   // Create a MultiFab with all of the non-reacting source terms.
-  amrex::MultiFab non_react_src_tmp;
   amrex::MultiFab* non_react_src = nullptr;
 
   if (react_init) {
-    non_react_src_tmp.define(grids, dmap, NVAR, ng, amrex::MFInfo(), Factory());
-    non_react_src_tmp.setVal(0);
-    non_react_src = &non_react_src_tmp;
+    react_non_react_src.setVal(0);
+    non_react_src = &react_non_react_src;
   } else {
     // Only do this if we are not at the first step
     // Build non-reacting source term, and an S_new that does not include
     // reactions
     if (aux_src == nullptr) {
-      non_react_src_tmp.define(
-        grids, dmap, NVAR, ng, amrex::MFInfo(), Factory());
-      non_react_src_tmp.setVal(0);
-      non_react_src = &non_react_src_tmp;
+      non_react_src = &react_non_react_src;
 
+      amrex::Vector<std::pair<amrex::Real, const amrex::MultiFab*>> terms;
       for (int src : src_list) {
-        amrex::MultiFab::Saxpy(
-          non_react_src_tmp, 0.5, *new_sources[src], 0, 0, NVAR, ng);
-        amrex::MultiFab::Saxpy(
-          non_react_src_tmp, 0.5, *old_sources[src], 0, 0, NVAR, ng);
+        terms.push_back({0.5, new_sources[src].get()});
+        terms.push_back({0.5, old_sources[src].get()});
       }
-
       if (do_hydro && !do_mol) {
-        amrex::MultiFab::Add(non_react_src_tmp, hydro_source, 0, 0, NVAR, ng);
+        terms.push_back({1.0, &hydro_source});
       }
+      fused_state_update(react_non_react_src, terms, 0.0, nullptr, ng);
     } else {
       // in MOL update all non-reacting sources
       // are passed into auxiliary sources
@@ -88,35 +738,33 @@ PeleC::react_state(
 
     // S_new = S_old + dt*(non reacting source terms)
     const amrex::MultiFab& S_old = get_old_data(State_Type);
-    amrex::MultiFab::Copy(S_new, S_old, 0, 0, NVAR, ng);
-    amrex::MultiFab::Saxpy(S_new, dt, *non_react_src, 0, 0, NVAR, ng);
+    fused_state_update(
+      S_new, {{1.0, &S_old}, {dt, non_react_src}}, 0.0, nullptr, ng);
   }
 
   amrex::MultiFab& react_src = get_new_data(Reactions_Type);
+
+  // Flag the chemically active cells, this uses the reaction source from the
+  // previous step so it must be done before resetting it, the mask covers
+  // the same grown boxes as the reactor data
+  amrex::iMultiFab& reactMask = react_mask;
+  build_react_mask(
+    react_init ? S_new : get_old_data(State_Type), react_src, reactMask,
+    ng_react, react_init);
+
+  if (react_active_cells && (verbose > 1)) {
+    const amrex::Long nactive = reactMask.sum(0);
+    amrex::Print() << "... Chemically active cells: " << nactive << " of "
+                   << grids.numPts() << std::endl;
+  }
+
   react_src.setVal(0.0);
 
   // for sundials box integration
-  amrex::MultiFab STemp(grids, dmap, NUM_SPECIES + 2, 0);
-  amrex::MultiFab extsrc_rY(grids, dmap, NUM_SPECIES, 0);
-  amrex::MultiFab extsrc_rE(grids, dmap, 1, 0);
-  amrex::iMultiFab dummyMask(grids, dmap, 1, 0);
-  amrex::MultiFab fctCount(grids, dmap, 1, 0);
-  dummyMask.setVal(1);
-
-  if (!react_init) {
-    const amrex::MultiFab& S_old = get_old_data(State_Type);
-    amrex::MultiFab::Copy(STemp, S_old, UFS, 0, NUM_SPECIES, STemp.nGrow());
-    amrex::MultiFab::Copy(STemp, S_old, UTEMP, NUM_SPECIES, 1, STemp.nGrow());
-    amrex::MultiFab::Copy(
-      STemp, S_old, UEINT, NUM_SPECIES + 1, 1, STemp.nGrow());
-  } else {
-    amrex::MultiFab::Copy(STemp, S_new, UFS, 0, NUM_SPECIES, STemp.nGrow());
-    amrex::MultiFab::Copy(STemp, S_new, UTEMP, NUM_SPECIES, 1, STemp.nGrow());
-    amrex::MultiFab::Copy(
-      STemp, S_new, UEINT, NUM_SPECIES + 1, 1, STemp.nGrow());
-  }
-  amrex::MultiFab::Copy(
-    extsrc_rY, *non_react_src, UFS, 0, NUM_SPECIES, STemp.nGrow());
+  amrex::MultiFab& STemp = react_STemp;
+  amrex::MultiFab& extsrc_rY = react_extsrc_rY;
+  amrex::MultiFab& extsrc_rE = react_extsrc_rE;
+  amrex::MultiFab& fctCount = react_fctCount;
 
   auto const& fact =
     dynamic_cast<amrex::EBFArrayBoxFactory const&>(S_new.Factory());
@@ -130,6 +778,25 @@ PeleC::react_state(
   amrex::GpuArray<amrex::Real, AMREX_SPACEDIM> axis_loc = {
     AMREX_D_DECL(rf_axis_x, rf_axis_y, rf_axis_z)};
 
+  // Chemistry step estimate from the previous step, only registered when
+  // the cells are sorted by cost
+  const amrex::MultiFab* chem_dt_old = nullptr;
+  if (react_sort_by_cost) {
+    chem_dt_old = react_init ? &get_new_data(Chem_Step_Type)
+                             : &get_old_data(Chem_Step_Type);
+  }
+
+  if (react_cache) {
+    chem_cache->resetStats();
+  }
+
+  // Cells from all the local tiles are integrated together in batches
+  const bool batched = (react_batch_size != 0);
+
+  // Pack the reactor data directly from the state and the non-reacting
+  // sources
+  amrex::Real pack_time = amrex::ParallelDescriptor::second();
+  BL_PROFILE_VAR("PeleC::react_state()::pack", pack);
 #ifdef AMREX_USE_OMP
 #pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
 #endif
@@ -137,20 +804,7 @@ PeleC::react_state(
     for (amrex::MFIter mfi(S_new, amrex::TilingIfNotGPU()); mfi.isValid();
          ++mfi) {
 
-      const amrex::Box& bx = mfi.growntilebox(ng);
-
-      // old state or the state at t=0
-      auto const& sold_arr =
-        react_init ? S_new.array(mfi) : get_old_data(State_Type).array(mfi);
-
-      // new state
-      auto const& snew_arr = S_new.array(mfi);
-      auto const& nonrs_arr = non_react_src->array(mfi);
-      auto const& I_R = react_src.array(mfi);
-
-      // only update beyond first step
-      // TODO: Update here? Or just get reaction source?
-      const bool do_update = !react_init;
+      const amrex::Box& bx = mfi.growntilebox(ng_react);
 
       const auto& flag_fab = flags[mfi];
       amrex::FabType typ = flag_fab.getType(bx);
@@ -165,22 +819,31 @@ PeleC::react_state(
       if (
         (typ == amrex::FabType::singlevalued) ||
         (typ == amrex::FabType::regular)) {
-        amrex::Real wt =
-          amrex::ParallelDescriptor::second(); // timing for each fab
+        // old state or the state at t=0
+        auto const& sold_arr = react_init
+                                 ? S_new.const_array(mfi)
+                                 : get_old_data(State_Type).const_array(mfi);
 
-        amrex::Real current_time = 0.0;
+        // new state
+        auto const& snew_arr = S_new.const_array(mfi);
+        auto const& nonrs_arr = non_react_src->const_array(mfi);
 
         auto const& rhoY = STemp.array(mfi);
         auto const& T = STemp.array(mfi, NUM_SPECIES);
         auto const& rhoE = STemp.array(mfi, NUM_SPECIES + 1);
         auto const& frcExt = extsrc_rY.array(mfi);
         auto const& frcEExt = extsrc_rE.array(mfi);
-        auto const& mask = dummyMask.array(mfi);
-        auto const& fc = fctCount.array(mfi);
 
         amrex::ParallelFor(
           bx, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
             amrex::IntVect iv(AMREX_D_DECL(i, j, k));
+            for (int nsp = 0; nsp < NUM_SPECIES; nsp++) {
+              rhoY(i, j, k, nsp) = sold_arr(i, j, k, UFS + nsp);
+              frcExt(i, j, k, nsp) = nonrs_arr(i, j, k, UFS + nsp);
+            }
+            T(i, j, k) = sold_arr(i, j, k, UTEMP);
+            rhoE(i, j, k) = sold_arr(i, j, k, UEINT);
+
             // work on old state
             amrex::Real rhou = sold_arr(i, j, k, UMX);
             amrex::Real rhov = sold_arr(i, j, k, UMY);
@@ -218,18 +881,141 @@ PeleC::react_state(
 
             frcEExt(i, j, k) = rhoedot_ext;
           });
+      }
+    }
+  }
+  amrex::Gpu::Device::streamSynchronize();
+  BL_PROFILE_VAR_STOP(pack);
+  pack_time = amrex::ParallelDescriptor::second() - pack_time;
+
+  amrex::Real integrate_time = amrex::ParallelDescriptor::second();
+  BL_PROFILE_VAR("PeleC::react_state()::integrate", integrate);
+  if (batched) {
+    // the batched integration is done for all the tiles at once
+    react_batched(
+      STemp, extsrc_rY, extsrc_rE, fctCount, reactMask, chem_dt_old, ng_react,
+      dt);
+  } else {
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+    {
+      for (amrex::MFIter mfi(S_new, amrex::TilingIfNotGPU()); mfi.isValid();
+           ++mfi) {
+
+        const amrex::Box& bx = mfi.growntilebox(ng_react);
+
+        const auto& flag_fab = flags[mfi];
+        amrex::FabType typ = flag_fab.getType(bx);
+        if (
+          (typ == amrex::FabType::singlevalued) ||
+          (typ == amrex::FabType::regular)) {
+          amrex::Real wt =
+            amrex::ParallelDescriptor::second(); // timing for each fab
+
+          amrex::Real current_time = 0.0;
 
-        reactor->react(
-          bx, rhoY, frcExt, T, rhoE, frcEExt, fc, mask, dt, current_time
+          auto const& rhoY = STemp.array(mfi);
+          auto const& T = STemp.array(mfi, NUM_SPECIES);
+          auto const& rhoE = STemp.array(mfi, NUM_SPECIES + 1);
+          auto const& frcExt = extsrc_rY.array(mfi);
+          auto const& frcEExt = extsrc_rE.array(mfi);
+          auto const& mask = reactMask.array(mfi);
+          auto const& fc = fctCount.array(mfi);
+
+          if (react_cache) {
+            react_cached_tile(
+              bx, rhoY, frcExt, T, rhoE, frcEExt, fc, mask, dt, current_time);
+          } else if (react_active_cells) {
+            react_active_tile(
+              bx, rhoY, frcExt, T, rhoE, frcEExt, fc, mask, dt, current_time);
+          } else {
+            reactor->react(
+              bx, rhoY, frcExt, T, rhoE, frcEExt, fc, mask, dt, current_time
 #ifdef AMREX_USE_GPU
-          ,
-          amrex::Gpu::gpuStream()
+              ,
+              amrex::Gpu::gpuStream()
 #endif
-        );
+            );
+          }
+
+          amrex::Gpu::Device::streamSynchronize();
+
+          wt = amrex::ParallelDescriptor::second() - wt;
+
+          if (do_react_load_balance) {
+            // Distribute the tile wall time according to the per-cell
+            // number of RHS evaluations of the reactor
+            const amrex::Box vbox = mfi.tilebox();
+            const amrex::Real fc_sum =
+              fctCount[mfi].sum<amrex::RunOn::Device>(vbox, 0);
+            const amrex::Real w_fc =
+              (fc_sum > 0.0) ? react_work_estimate_fc_weight : 0.0;
+            // The uniform part is split as before the weighting was added
+            const amrex::Real wt_cell = (1.0 - w_fc) * wt / bx.d_numPts();
+            const amrex::Real wt_fc =
+              (fc_sum > 0.0) ? w_fc * wt / fc_sum : 0.0;
+            auto const& west = get_new_data(Work_Estimate_Type).array(mfi);
+            amrex::ParallelFor(
+              vbox, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
+                west(i, j, k) += wt_cell + wt_fc * fc(i, j, k);
+              });
+          }
+        }
+      }
+    }
+  }
+  BL_PROFILE_VAR_STOP(integrate);
+  integrate_time = amrex::ParallelDescriptor::second() - integrate_time;
+
+  // Unpack the reactor data into the new state, the reaction sources, the
+  // heat release and the chemistry step estimate in a single pass
+  amrex::Real unpack_time = amrex::ParallelDescriptor::second();
+  BL_PROFILE_VAR("PeleC::react_state()::unpack", unpack);
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+  {
+    for (amrex::MFIter mfi(S_new, amrex::TilingIfNotGPU()); mfi.isValid();
+         ++mfi) {
 
-        amrex::Gpu::Device::streamSynchronize();
+      const amrex::Box& bx = mfi.growntilebox(ng_react);
+
+      const auto& flag_fab = flags[mfi];
+      amrex::FabType typ = flag_fab.getType(bx);
+      if (
+        (typ == amrex::FabType::singlevalued) ||
+        (typ == amrex::FabType::regular)) {
+        // old state or the state at t=0
+        auto const& sold_arr = react_init
+                                 ? S_new.const_array(mfi)
+                                 : get_old_data(State_Type).const_array(mfi);
+
+        // new state
+        auto const& snew_arr = S_new.array(mfi);
+        auto const& nonrs_arr = non_react_src->const_array(mfi);
+        auto const& I_R = react_src.array(mfi);
+
+        // only update beyond first step
+        // TODO: Update here? Or just get reaction source?
+        const bool do_update = !react_init;
+
+        auto const& rhoY = STemp.const_array(mfi);
+        auto const& T = STemp.const_array(mfi, NUM_SPECIES);
+        auto const& frcEExt = extsrc_rE.const_array(mfi);
+        auto const& mask = reactMask.const_array(mfi);
+
+        // record the chemistry step estimate of the reacted cells
+        const bool record_chem_dt = react_sort_by_cost;
+        const amrex::Box vbox = mfi.tilebox();
+        auto const& fc = fctCount.const_array(mfi);
+        auto const& hc_old = react_sort_by_cost
+                               ? chem_dt_old->const_array(mfi)
+                               : amrex::Array4<const amrex::Real>();
+        auto const& hc_new = react_sort_by_cost
+                               ? get_new_data(Chem_Step_Type).array(mfi)
+                               : amrex::Array4<amrex::Real>();
 
-        // unpack data
         amrex::ParallelFor(
           bx, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
             // work on old state
@@ -252,17 +1038,8 @@ PeleC::react_state(
 
             e_old += rotenrg;
 
-            rhou = snew_arr(i, j, k, UMX);
-            rhov = snew_arr(i, j, k, UMY);
-            rhow = snew_arr(i, j, k, UMZ);
-            rhoInv = 1.0 / snew_arr(i, j, k, URHO);
-
-            amrex::Real rhoedot_ext =
-              (snew_arr(i, j, k, UEDEN) // new total energy
-               - 0.5 * (rhou * rhou + rhov * rhov + rhow * rhow) * rhoInv // KE
-               + snew_arr(i, j, k, URHO) * rotenrg -
-               rho_old * e_old) // old internal energy
-              / dt;
+            // computed from the same states when packing
+            const amrex::Real rhoedot_ext = frcEExt(i, j, k);
 
             amrex::Real umnew =
               sold_arr(i, j, k, UMX) + dt * nonrs_arr(i, j, k, UMX);
@@ -296,6 +1073,24 @@ PeleC::react_state(
                 rhonew * rotenrg;
             }
 
+            if (record_chem_dt && vbox.contains(iv)) {
+              hc_new(i, j, k) =
+                (fc(i, j, k) > 0.0) ? dt / fc(i, j, k) : hc_old(i, j, k);
+            }
+
+            // the reaction sources are only stored on the valid cells
+            if (!I_R.contains(i, j, k)) {
+              return;
+            }
+
+            // inert cells only received the non-reacting update
+            if (mask(i, j, k) == 0) {
+              for (int nsp = 0; nsp < NUM_SPECIES + 2; nsp++) {
+                I_R(i, j, k, nsp) = 0.0;
+              }
+              return;
+            }
+
             for (int nsp = 0; nsp < NUM_SPECIES; nsp++) {
               I_R(i, j, k, nsp) = (rhoY(i, j, k, nsp)              // new rhoy
                                    - sold_arr(i, j, k, UFS + nsp)) // old rhoy
@@ -311,20 +1106,8 @@ PeleC::react_state(
                - sold_arr(i, j, k, UEDEN)) // old total energy
                 / dt -
               nonrs_arr(i, j, k, UEDEN);
-          });
 
-        wt = (amrex::ParallelDescriptor::second() - wt) / bx.d_numPts();
-
-        if (do_react_load_balance) {
-          const amrex::Box vbox = mfi.tilebox();
-          get_new_data(Work_Estimate_Type)[mfi].plus<amrex::RunOn::Device>(
-            wt, vbox);
-        }
-
-        // update heat release
-        amrex::ParallelFor(
-          bx, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
-            I_R(i, j, k, NUM_SPECIES + 1) = 0.0;
+            // heat release
             auto eos = pele::physics::PhysicsType::eos();
 
             amrex::Real hi[NUM_SPECIES] = {0.0};
@@ -336,7 +1119,7 @@ PeleC::react_state(
             }
             eos.RTY2Hi(
               snew_arr(i, j, k, URHO), snew_arr(i, j, k, UTEMP), Yspec, hi);
-
+            I_R(i, j, k, NUM_SPECIES + 1) = 0.0;
             for (int nsp = 0; nsp < NUM_SPECIES; nsp++) {
               I_R(i, j, k, NUM_SPECIES + 1) -= hi[nsp] * I_R(i, j, k, nsp);
             }
@@ -344,19 +1127,51 @@ PeleC::react_state(
       }
     }
   }
+  amrex::Gpu::Device::streamSynchronize();
+  BL_PROFILE_VAR_STOP(unpack);
+  unpack_time = amrex::ParallelDescriptor::second() - unpack_time;
 
   if (ng > 0) {
     S_new.FillBoundary(geom.periodicity());
   }
+  if (react_src.nGrow() > 0) {
+    react_src.FillBoundary(geom.periodicity());
+  }
+
+  if (react_cache && (verbose != 0)) {
+    const int IOProc = amrex::ParallelDescriptor::IOProcessorNumber();
+    const auto& stats = chem_cache->stats();
+    amrex::Vector<amrex::Long> counts = {
+      stats.hits, stats.misses, stats.grows, stats.adds, stats.evictions,
+      chem_cache->size()};
+    amrex::Long bytes = chem_cache->bytes();
+    amrex::ParallelDescriptor::ReduceLongSum(
+      counts.data(), static_cast<int>(counts.size()), IOProc);
+    amrex::ParallelDescriptor::ReduceLongMax(bytes, IOProc);
+
+    if (amrex::ParallelDescriptor::IOProcessor()) {
+      amrex::Print() << "... Chemistry cache: " << counts[0] << " hits, "
+                     << counts[1] << " misses, " << counts[2] << " grows, "
+                     << counts[3] << " adds, " << counts[4] << " evictions, "
+                     << counts[5] << " entries (max " << bytes
+                     << " bytes per rank)" << std::endl;
+    }
+  }
 
   if (verbose > 1) {
     const int IOProc = amrex::ParallelDescriptor::IOProcessorNumber();
     amrex::Real run_time = amrex::ParallelDescriptor::second() - strt_time;
 
+    amrex::Real phase_times[3] = {pack_time, integrate_time, unpack_time};
+
     amrex::ParallelDescriptor::ReduceRealMax(run_time, IOProc);
+    amrex::ParallelDescriptor::ReduceRealMax(phase_times, 3, IOProc);
 
     if (amrex::ParallelDescriptor::IOProcessor()) {
-      amrex::Print() << "PeleC::react_state() time = " << run_time << "\n";
+      amrex::Print() << "PeleC::react_state() time = " << run_time
+                     << " (pack = " << phase_times[0]
+                     << ", integrate = " << phase_times[1]
+                     << ", unpack = " << phase_times[2] << ")\n";
     }
   }
 }
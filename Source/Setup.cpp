@@ -1,5 +1,6 @@
 #include <AMReX_ParmParse.H>
 #include <AMReX_buildInfo.H>
+#include <algorithm>
 #include <memory>
 
 #ifdef PELE_USE_MASA
@@ -123,6 +124,160 @@ PeleC::check_params()
     AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
       do_mol, "Rotational frame simulations require use of MOL");
   }
+
+  // reaction work estimate
+  AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+    (react_work_estimate_fc_weight >= 0.0) &&
+      (react_work_estimate_fc_weight <= 1.0),
+    "pelec.react_work_estimate_fc_weight must be in [0, 1]");
+
+  // chemistry cache
+  if (react_cache) {
+#ifdef AMREX_USE_GPU
+    amrex::Abort("pelec.react_cache is not supported on GPUs");
+#endif
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+      react_batch_size == 0,
+      "pelec.react_cache is not compatible with pelec.react_batch_size");
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+      (react_cache_tol > 0.0) && (react_cache_size > 0),
+      "pelec.react_cache_tol and pelec.react_cache_size must be positive");
+  }
+
+  // batched chemistry sorted by cost
+  if (react_sort_by_cost) {
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+      react_batch_size != 0,
+      "pelec.react_sort_by_cost requires pelec.react_batch_size");
+  }
+
+  // chemically active cells
+  if (react_active_cells && (react_active_fuel >= 0.0)) {
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+      !fuel_name.empty(), "pelec.react_active_fuel requires pelec.fuel_name");
+  }
+
+  // transport table
+  if (transport_table) {
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+      (transport_table_nT > 1) && (transport_table_nZ > 0),
+      "pelec.transport_table_nT must be > 1 and pelec.transport_table_nZ > 0");
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+      (transport_table_Tmax > transport_table_Tmin) &&
+        (transport_table_Tmin > 0.0),
+      "pelec.transport_table_Tmin/Tmax are not valid");
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+      !do_react,
+      "pelec.transport_table assumes non-reacting mixing, it is not "
+      "compatible with pelec.do_react");
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+      transport_table_mix_tol > 0.0,
+      "pelec.transport_table_mix_tol must be positive");
+  }
+
+  // MOL integrator
+  if (do_mol) {
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+      (mol_integrator >= 0) && (mol_integrator <= 2),
+      "pelec.mol_integrator must be 0, 1 or 2");
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+      (mol_integrator == 0) || ((mol_iters == 1) && (mol_iters_max <= 1)),
+      "pelec.mol_iters > 1 requires pelec.mol_integrator = 0");
+  }
+
+  // adaptive SDC and MOL iterations
+  AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+    (sdc_iter_tol >= 0.0) && (mol_iter_tol >= 0.0),
+    "pelec.sdc_iter_tol and pelec.mol_iter_tol must be non-negative");
+  AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+    (sdc_iters >= 1) && (mol_iters >= 1) && (sdc_iters_max >= 0) &&
+      (mol_iters_max >= 0),
+    "pelec.sdc_iters, pelec.mol_iters must be positive and "
+    "pelec.sdc_iters_max, pelec.mol_iters_max non-negative");
+
+  // lagged transport coefficients
+  AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+    (transport_lag_tol >= 0.0) && (transport_lag_interval >= 0),
+    "pelec.transport_lag_tol and pelec.transport_lag_interval must be "
+    "non-negative");
+
+  // asynchronous plotfiles
+  AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+    async_plotfiles_max_pending > 0,
+    "pelec.async_plotfiles_max_pending must be positive");
+}
+
+void
+PeleC::init_transport_table()
+{
+  amrex::Vector<std::string> names;
+  pele::physics::eos::speciesNames<pele::physics::PhysicsType::eos_type>(
+    names);
+  auto eos = pele::physics::PhysicsType::eos();
+
+  // Mass fractions of a stream given by its species names and mole fractions
+  amrex::ParmParse pp("pelec");
+  auto read_stream = [&](const std::string& stream, amrex::Real Y[]) {
+    amrex::Vector<std::string> species;
+    amrex::Vector<amrex::Real> X_in;
+    pp.queryarr(stream.c_str(), species);
+    if (species.empty()) {
+      return false;
+    }
+    pp.queryarr((stream + "_X").c_str(), X_in);
+    if (X_in.empty() && (species.size() == 1)) {
+      X_in.push_back(1.0);
+    }
+    if (X_in.size() != species.size()) {
+      amrex::Abort(
+        "pelec." + stream + "_X must give the mole fraction of each species");
+    }
+    amrex::Real X[NUM_SPECIES] = {0.0};
+    amrex::Real sum = 0.0;
+    for (int i = 0; i < static_cast<int>(species.size()); i++) {
+      const auto it = std::find(names.begin(), names.end(), species[i]);
+      if (it == names.end()) {
+        amrex::Abort("Unknown species " + species[i] + " in pelec." + stream);
+      }
+      X[std::distance(names.begin(), it)] += X_in[i];
+      sum += X_in[i];
+    }
+    if (sum <= 0.0) {
+      amrex::Abort("pelec." + stream + "_X must have a positive sum");
+    }
+    for (amrex::Real& Xn : X) {
+      Xn /= sum;
+    }
+    eos.X2Y(X, Y);
+    return true;
+  };
+
+  amrex::Real Y0[NUM_SPECIES] = {0.0};
+  amrex::Real Y1[NUM_SPECIES] = {0.0};
+  if (!read_stream("transport_table_stream0", Y0)) {
+    amrex::Abort(
+      "pelec.transport_table requires pelec.transport_table_stream0");
+  }
+  const bool two_streams = read_stream("transport_table_stream1", Y1);
+  const int nZ = two_streams ? transport_table_nZ : 1;
+
+  trans_table = std::make_unique<TransportTable>(
+    transport_table_nT, nZ, transport_table_Tmin, transport_table_Tmax,
+    transport_table_pressure, Y0, Y1, trans_parms.device_parm());
+
+  // Compare with the direct evaluation
+  const amrex::Real err = trans_table->verify(trans_parms.device_parm());
+  if (verbose != 0) {
+    amrex::Print() << "Transport table: " << transport_table_nT << " x " << nZ
+                   << " points (" << trans_table->bytes() / 1024
+                   << " kB), max relative error " << err << std::endl;
+  }
+  if (err > transport_table_tol) {
+    amrex::Abort(
+      "Transport table relative error " + std::to_string(err) +
+      " exceeds pelec.transport_table_tol, increase "
+      "pelec.transport_table_nT or pelec.transport_table_nZ");
+  }
 }
 
 void
@@ -185,6 +340,9 @@ PeleC::variableSetUp()
   eb_in_domain = ebInDomain();
   read_params();
   check_params();
+  if (transport_table) {
+    init_transport_table();
+  }
 
 #ifdef PELE_USE_MASA
   if (do_mms) {
@@ -418,6 +576,19 @@ PeleC::variableSetUp()
     Work_Estimate_Type, 0, "WorkEstimate", bc,
     amrex::StateDescriptor::BndryFunc(pc_nullfill));
 
+  // Estimate of the chemistry integration step, persisted across steps. It
+  // is only registered when used, so it must remain the last state type
+  if (do_react && react_sort_by_cost) {
+    const bool chemdt_store_in_checkpoint = true;
+    desc_lst.addDescriptor(
+      Chem_Step_Type, amrex::IndexType::TheCellType(),
+      amrex::StateDescriptor::Point, 0, 1, &amrex::pc_interp, false,
+      chemdt_store_in_checkpoint);
+    desc_lst.setComponent(
+      Chem_Step_Type, 0, "chem_dt", bc,
+      amrex::StateDescriptor::BndryFunc(pc_nullfill));
+  }
+
   num_state_type = desc_lst.size();
 
   // Get the level at which EB is generated
@@ -720,6 +891,7 @@ PeleC::variableCleanUp()
   delete tagging_parm;
   delete h_prob_parm_device;
   amrex::The_Arena()->free(d_prob_parm_device);
+  trans_table.reset();
   trans_parms.deallocate();
 #ifdef PELE_USE_SPRAY
   SprayParticleContainer::SprayCleanUp();
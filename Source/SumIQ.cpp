@@ -1,7 +1,240 @@
 #include <iomanip>
+#include <limits>
+
+#include <AMReX_ConstexprFor.H>
+#include <AMReX_Reduce.H>
+#include <AMReX_TypeList.H>
 
 #include "PeleC.H"
 
+namespace {
+
+// Integrated quantities of sum_integrated_quantities
+enum SumIQ {
+  SumMass = 0,
+  SumXMom,
+  SumYMom,
+  SumZMom,
+  SumRhoe,
+  SumRhoK,
+  SumRhoE,
+  SumFuelProd,
+  SumTemp,
+  NumSumIQ
+};
+
+// Extrema of monitor_extrema, followed by the mass fractions of up to
+// NumExtremaSpec species
+enum ExtremaIQ {
+  ExtDensity = 0,
+  ExtXVel,
+  ExtYVel,
+  ExtZVel,
+  ExtEint,
+  ExtTemp,
+  ExtPres,
+  ExtMassfrac,
+  ExtSumYminus1,
+  NumExtremaIQ
+};
+constexpr int NumExtremaSpec = 4;
+constexpr int NumExtremaVals = 2 * (NumExtremaIQ + NumExtremaSpec);
+
+template <typename Tuple, int N>
+AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE Tuple
+to_tuple(const amrex::Real (&v)[N])
+{
+  Tuple t;
+  amrex::constexpr_for<0, N>([&](auto n) { amrex::get<n>(t) = v[n]; });
+  return t;
+}
+
+template <int N, typename Tuple>
+void
+from_tuple(const Tuple& t, amrex::Real* v)
+{
+  amrex::constexpr_for<0, N>([&](auto n) { v[n] = amrex::get<n>(t); });
+}
+
+} // namespace
+
+amrex::Vector<amrex::Real>
+PeleC::volWgtSumIQ(const int fuel_comp)
+{
+  BL_PROFILE("PeleC::volWgtSumIQ()");
+
+  const amrex::MultiFab& S = get_new_data(State_Type);
+  const amrex::MultiFab& R = get_new_data(Reactions_Type);
+  const bool use_mask = level < parent->finestLevel();
+  const amrex::MultiFab* mask =
+    use_mask ? &getLevel(level + 1).build_fine_mask() : nullptr;
+  const bool use_vfrac = eb_in_domain;
+
+  amrex::TypeMultiplier<amrex::ReduceOps, amrex::ReduceOpSum[NumSumIQ]>
+    reduce_op;
+  amrex::TypeMultiplier<amrex::ReduceData, amrex::Real[NumSumIQ]> reduce_data(
+    reduce_op);
+  using ReduceTuple = typename decltype(reduce_data)::Type;
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+  for (amrex::MFIter mfi(S, amrex::TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+    const amrex::Box& bx = mfi.tilebox();
+    auto const& s = S.const_array(mfi);
+    auto const& r = R.const_array(mfi);
+    auto const& vol = volume.const_array(mfi);
+    amrex::Array4<const amrex::Real> m;
+    if (use_mask) {
+      m = mask->const_array(mfi);
+    }
+    amrex::Array4<const amrex::Real> vf;
+    if (use_vfrac) {
+      vf = vfrac.const_array(mfi);
+    }
+    reduce_op.eval(
+      bx, reduce_data,
+      [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept -> ReduceTuple {
+        amrex::Real w = vol(i, j, k);
+        if (use_mask) {
+          w *= m(i, j, k);
+        }
+        if (use_vfrac) {
+          w *= vf(i, j, k);
+        }
+        const amrex::Real rho = s(i, j, k, URHO);
+        const amrex::Real mx = s(i, j, k, UMX);
+        const amrex::Real my = s(i, j, k, UMY);
+        const amrex::Real mz = s(i, j, k, UMZ);
+        amrex::Real v[NumSumIQ];
+        v[SumMass] = w * rho;
+        v[SumXMom] = w * mx;
+        v[SumYMom] = w * my;
+        v[SumZMom] = w * mz;
+        v[SumRhoe] = w * s(i, j, k, UEINT);
+        v[SumRhoK] = w * 0.5 / rho * (mx * mx + my * my + mz * mz);
+        v[SumRhoE] = w * s(i, j, k, UEDEN);
+        v[SumFuelProd] = (fuel_comp >= 0) ? w * r(i, j, k, fuel_comp) : 0.0;
+        v[SumTemp] = w * s(i, j, k, UTEMP);
+        return to_tuple<ReduceTuple>(v);
+      });
+  }
+
+  amrex::Vector<amrex::Real> sums(NumSumIQ);
+  from_tuple<NumSumIQ>(reduce_data.value(reduce_op), sums.data());
+  return sums;
+}
+
+void
+PeleC::extremaIQ(
+  const amrex::Vector<int>& spec_comps,
+  amrex::Vector<amrex::Real>& minima,
+  amrex::Vector<amrex::Real>& maxima)
+{
+  BL_PROFILE("PeleC::extremaIQ()");
+
+  // Includes all cells, even those covered by finer grids or EB
+  const amrex::MultiFab& S = get_new_data(State_Type);
+  const auto nspec = static_cast<int>(spec_comps.size());
+  minima.assign(NumExtremaIQ + nspec, std::numeric_limits<amrex::Real>::max());
+  maxima.assign(
+    NumExtremaIQ + nspec, std::numeric_limits<amrex::Real>::lowest());
+
+  // All the values are reduced with a max, the minima are negated. The
+  // species beyond the first NumExtremaSpec take additional passes.
+  for (int first = 0; (first == 0) || (first < nspec);
+       first += NumExtremaSpec) {
+    const bool fixed = first == 0;
+    amrex::GpuArray<int, NumExtremaSpec> comps;
+    for (int n = 0; n < NumExtremaSpec; ++n) {
+      comps[n] = (first + n < nspec) ? spec_comps[first + n] : -1;
+    }
+
+    amrex::TypeMultiplier<amrex::ReduceOps, amrex::ReduceOpMax[NumExtremaVals]>
+      reduce_op;
+    amrex::TypeMultiplier<amrex::ReduceData, amrex::Real[NumExtremaVals]>
+      reduce_data(reduce_op);
+    using ReduceTuple = typename decltype(reduce_data)::Type;
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+    for (amrex::MFIter mfi(S, amrex::TilingIfNotGPU()); mfi.isValid();
+         ++mfi) {
+      const amrex::Box& bx = mfi.tilebox();
+      auto const& s = S.const_array(mfi);
+      reduce_op.eval(
+        bx, reduce_data,
+        [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept -> ReduceTuple {
+          constexpr amrex::Real neg_huge =
+            std::numeric_limits<amrex::Real>::lowest();
+          amrex::Real val[NumExtremaIQ + NumExtremaSpec];
+          amrex::Real vmin[NumExtremaIQ + NumExtremaSpec];
+          for (int n = 0; n < NumExtremaIQ + NumExtremaSpec; ++n) {
+            val[n] = neg_huge;
+            vmin[n] = -neg_huge;
+          }
+          const amrex::Real rho = s(i, j, k, URHO);
+          const amrex::Real rhoInv = 1.0 / rho;
+          if (fixed) {
+            amrex::Real massfrac[NUM_SPECIES];
+            amrex::Real Ymin = std::numeric_limits<amrex::Real>::max();
+            amrex::Real Ymax = neg_huge;
+            amrex::Real sumY = 0.0;
+            for (int n = 0; n < NUM_SPECIES; ++n) {
+              massfrac[n] = s(i, j, k, UFS + n) * rhoInv;
+              Ymin = amrex::min(Ymin, massfrac[n]);
+              Ymax = amrex::max(Ymax, massfrac[n]);
+              sumY += massfrac[n];
+            }
+            amrex::Real T = s(i, j, k, UTEMP);
+            amrex::Real p;
+            auto eos = pele::physics::PhysicsType::eos();
+            eos.RTY2P(rho, T, massfrac, p);
+
+            val[ExtDensity] = rho;
+            val[ExtXVel] = s(i, j, k, UMX) * rhoInv;
+            val[ExtYVel] = s(i, j, k, UMY) * rhoInv;
+            val[ExtZVel] = s(i, j, k, UMZ) * rhoInv;
+            val[ExtEint] = s(i, j, k, UEINT) * rhoInv;
+            val[ExtTemp] = T;
+            val[ExtPres] = p;
+            val[ExtMassfrac] = Ymax;
+            val[ExtSumYminus1] = sumY - 1.0;
+            for (int n = 0; n < NumExtremaIQ; ++n) {
+              vmin[n] = val[n];
+            }
+            vmin[ExtMassfrac] = Ymin;
+          }
+          for (int n = 0; n < NumExtremaSpec; ++n) {
+            if (comps[n] >= 0) {
+              val[NumExtremaIQ + n] = s(i, j, k, UFS + comps[n]) * rhoInv;
+              vmin[NumExtremaIQ + n] = val[NumExtremaIQ + n];
+            }
+          }
+
+          amrex::Real v[NumExtremaVals];
+          for (int n = 0; n < NumExtremaIQ + NumExtremaSpec; ++n) {
+            v[2 * n] = -vmin[n];
+            v[2 * n + 1] = val[n];
+          }
+          return to_tuple<ReduceTuple>(v);
+        });
+    }
+
+    amrex::Real v[NumExtremaVals];
+    from_tuple<NumExtremaVals>(reduce_data.value(reduce_op), v);
+    if (fixed) {
+      for (int n = 0; n < NumExtremaIQ; ++n) {
+        minima[n] = -v[2 * n];
+        maxima[n] = v[2 * n + 1];
+      }
+    }
+    for (int n = 0; (n < NumExtremaSpec) && (first + n < nspec); ++n) {
+      minima[NumExtremaIQ + first + n] = -v[2 * (NumExtremaIQ + n)];
+      maxima[NumExtremaIQ + first + n] = v[2 * (NumExtremaIQ + n) + 1];
+    }
+  }
+}
+
 void
 PeleC::sum_integrated_quantities()
 {
@@ -11,35 +244,33 @@ PeleC::sum_integrated_quantities()
     return;
   }
 
-  bool local_flag = true;
-
   int finest_level = parent->finestLevel();
   amrex::Real time = state[State_Type].curTime();
-  amrex::Real mass = 0.0;
-  amrex::Real mom[3] = {0.0};
-  amrex::Real rho_e = 0.0;
-  amrex::Real rho_K = 0.0;
-  amrex::Real rho_E = 0.0;
-  amrex::Real fuel_prod = 0;
-  amrex::Real temp = 0;
 
-  for (int lev = 0; lev <= finest_level; lev++) {
-    PeleC& pc_lev = getLevel(lev);
-
-    mass += pc_lev.volWgtSum("density", time, local_flag);
-    mom[0] += pc_lev.volWgtSum("xmom", time, local_flag);
-    mom[1] += pc_lev.volWgtSum("ymom", time, local_flag);
-    mom[2] += pc_lev.volWgtSum("zmom", time, local_flag);
-    rho_e += pc_lev.volWgtSum("rho_e", time, local_flag);
-    rho_K += pc_lev.volWgtSum("kineng", time, local_flag);
-    rho_E += pc_lev.volWgtSum("rho_E", time, local_flag);
-
-    if (!fuel_name.empty()) {
-      fuel_prod += pc_lev.volWgtSum("rho_omega_" + fuel_name, time, local_flag);
+  int fuel_comp = -1;
+  if (!fuel_name.empty()) {
+    fuel_comp = static_cast<int>(find_position(spec_names, fuel_name));
+    if (fuel_comp < 0) {
+      amrex::Abort("Unknown species identified as fuel_name");
     }
+  }
 
-    temp += pc_lev.volWgtSum("Temp", time, local_flag);
+  // Rank-local sums over all the levels, a single reduction follows
+  amrex::Vector<amrex::Real> sums(NumSumIQ, 0.0);
+  for (int lev = 0; lev <= finest_level; lev++) {
+    const amrex::Vector<amrex::Real> lev_sums =
+      getLevel(lev).volWgtSumIQ(fuel_comp);
+    for (int n = 0; n < NumSumIQ; n++) {
+      sums[n] += lev_sums[n];
+    }
   }
+  amrex::Real mass = sums[SumMass];
+  amrex::Real mom[3] = {sums[SumXMom], sums[SumYMom], sums[SumZMom]};
+  amrex::Real rho_e = sums[SumRhoe];
+  amrex::Real rho_K = sums[SumRhoK];
+  amrex::Real rho_E = sums[SumRhoE];
+  amrex::Real fuel_prod = sums[SumFuelProd];
+  amrex::Real temp = sums[SumTemp];
 
   if (verbose > 0) {
     const int nfoo = 10;
@@ -130,97 +361,60 @@ PeleC::monitor_extrema()
     return;
   }
 
-  const bool local_flag = true;
   const int finest_level = parent->finestLevel();
   const amrex::Real time = state[State_Type].curTime();
   amrex::Vector<std::string> extrema_vars = {
     "density", "x_velocity", "y_velocity", "z_velocity", "eint_e",
     "Temp",    "pressure",   "massfrac",   "sumYminus1"};
+  AMREX_ASSERT(static_cast<int>(extrema_vars.size()) == NumExtremaIQ);
 
-  int nspec_extrema = 2;
-  bool use_all_spec = false;
+  // Individual species to track
+  amrex::Vector<int> spec_comps;
   if (extrema_spec_name == "ALL") {
-    use_all_spec = true;
-    nspec_extrema += NUM_SPECIES;
-    extrema_vars.insert(
-      extrema_vars.end(), PeleC::spec_names.begin(), PeleC::spec_names.end());
-  } else {
-    if (!fuel_name.empty()) {
-      nspec_extrema++;
-      extrema_vars.push_back(fuel_name);
+    for (int n = 0; n < NUM_SPECIES; n++) {
+      spec_comps.push_back(n);
     }
-    if (!flame_trac_name.empty()) {
-      nspec_extrema++;
-      extrema_vars.push_back(flame_trac_name);
-    }
-    if (!extrema_spec_name.empty()) {
-      nspec_extrema++;
-      extrema_vars.push_back(extrema_spec_name);
+  } else {
+    for (const auto& name : {fuel_name, flame_trac_name, extrema_spec_name}) {
+      if (name.empty()) {
+        continue;
+      }
+      const auto idx = static_cast<int>(find_position(spec_names, name));
+      if (idx < 0) {
+        amrex::Abort("monitor_extrema: unknown species " + name);
+      }
+      spec_comps.push_back(idx);
     }
   }
+  for (const int n : spec_comps) {
+    extrema_vars.push_back(spec_names[n]);
+  }
 
   const auto nextrema = static_cast<int>(extrema_vars.size());
   constexpr amrex::Real neg_huge = std::numeric_limits<amrex::Real>::lowest();
-  constexpr amrex::Real huge = std::numeric_limits<amrex::Real>::max();
-  amrex::Vector<amrex::Real> minima(nextrema, huge), maxima(nextrema, neg_huge);
 
+  // Rank-local extrema over all the levels, the negated minima and the
+  // maxima are then reduced together
+  amrex::Vector<amrex::Real> extrema(2 * nextrema, neg_huge);
   for (int lev = 0; lev <= finest_level; lev++) {
-    PeleC& pc_lev = getLevel(lev);
-    for (int ii = 0; ii < nextrema - nspec_extrema; ++ii) {
-      maxima[ii] = amrex::max<amrex::Real>(
-        maxima[ii], pc_lev.maxDerive(extrema_vars[ii], time, local_flag));
-      minima[ii] = amrex::min<amrex::Real>(
-        minima[ii], pc_lev.minDerive(extrema_vars[ii], time, local_flag));
-    }
-
-    // Handle species separately
-    auto mf = pc_lev.derive("massfrac", time, 0);
-    BL_ASSERT(!(mf == nullptr));
-    amrex::MultiFab sumY(pc_lev.grids, pc_lev.dmap, 1, 0);
-    sumY.setVal(0.0);
-    const auto idx_massfrac = nextrema - nspec_extrema;
-
-    for (int ispec = 0; ispec < NUM_SPECIES; ispec++) {
-      amrex::Real maxval = mf->max(ispec, 0, local_flag);
-      amrex::Real minval = mf->min(ispec, 0, local_flag);
-      amrex::MultiFab::Add(sumY, *mf, ispec, 0, 1, 0);
-
-      // "massfrac" gets the extrema across all mass fractions
-      maxima[idx_massfrac] =
-        amrex::max<amrex::Real>(maxima[idx_massfrac], maxval);
-      minima[idx_massfrac] =
-        amrex::min<amrex::Real>(minima[idx_massfrac], minval);
-
-      // Get values for any individual species if relevant
-      if (use_all_spec) {
-        const auto idx_spec = idx_massfrac + ispec + 2;
-        maxima[idx_spec] = amrex::max<amrex::Real>(maxima[idx_spec], maxval);
-        minima[idx_spec] = amrex::min<amrex::Real>(minima[idx_spec], minval);
-      } else {
-        for (int iext = 0; iext < nspec_extrema - 2; iext++) {
-          const auto idx_spec = idx_massfrac + iext + 2;
-          if (extrema_vars[idx_spec] == PeleC::spec_names[ispec]) {
-            maxima[idx_spec] =
-              amrex::max<amrex::Real>(maxima[idx_spec], maxval);
-            minima[idx_spec] =
-              amrex::min<amrex::Real>(minima[idx_spec], minval);
-          }
-        }
-      }
+    amrex::Vector<amrex::Real> lev_minima, lev_maxima;
+    getLevel(lev).extremaIQ(spec_comps, lev_minima, lev_maxima);
+    for (int ii = 0; ii < nextrema; ++ii) {
+      extrema[ii] = amrex::max<amrex::Real>(extrema[ii], -lev_minima[ii]);
+      extrema[nextrema + ii] =
+        amrex::max<amrex::Real>(extrema[nextrema + ii], lev_maxima[ii]);
     }
-    // sum of mass fractions
-    maxima[idx_massfrac + 1] = amrex::max<amrex::Real>(
-      maxima[idx_massfrac + 1], sumY.max(0, 0, local_flag) - 1.0);
-    minima[idx_massfrac + 1] = amrex::min<amrex::Real>(
-      minima[idx_massfrac + 1], sumY.min(0, 0, local_flag) - 1.0);
   }
 
   if (verbose > 0) {
     amrex::ParallelDescriptor::ReduceRealMax(
-      maxima.data(), nextrema, amrex::ParallelDescriptor::IOProcessorNumber());
-
-    amrex::ParallelDescriptor::ReduceRealMin(
-      minima.data(), nextrema, amrex::ParallelDescriptor::IOProcessorNumber());
+      extrema.data(), 2 * nextrema,
+      amrex::ParallelDescriptor::IOProcessorNumber());
+    amrex::Vector<amrex::Real> minima(nextrema), maxima(nextrema);
+    for (int ii = 0; ii < nextrema; ++ii) {
+      minima[ii] = -extrema[ii];
+      maxima[ii] = extrema[nextrema + ii];
+    }
 
     if (amrex::ParallelDescriptor::IOProcessor()) {
 
@@ -0,0 +1,137 @@
+#include <limits>
+
+#include <AMReX_Reduce.H>
+#include <AMReX_BLassert.H>
+
+#include "TransportTable.H"
+
+TransportTable::TransportTable(
+  const int nT,
+  const int nZ,
+  const amrex::Real Tmin,
+  const amrex::Real Tmax,
+  const amrex::Real p,
+  const amrex::Real Y0[],
+  const amrex::Real Y1[],
+  TransParmType const* tparm)
+  : m_p(p)
+{
+  AMREX_ALWAYS_ASSERT((nT > 1) && (nZ > 0) && (Tmax > Tmin) && (p > 0.0));
+
+  const int ncomp = TransportTableData::ncomp;
+  const auto npts = static_cast<amrex::Long>(nT) * nZ;
+  m_data.resize(2 * NUM_SPECIES + npts * ncomp);
+
+  // Stream mass fractions
+  amrex::Vector<amrex::Real> h_streams(2 * NUM_SPECIES, 0.0);
+  amrex::Real dYnorm2 = 0.0;
+  for (int n = 0; n < NUM_SPECIES; ++n) {
+    h_streams[n] = Y0[n];
+    h_streams[NUM_SPECIES + n] = (nZ > 1) ? Y1[n] - Y0[n] : 0.0;
+    dYnorm2 += h_streams[NUM_SPECIES + n] * h_streams[NUM_SPECIES + n];
+  }
+  if (nZ > 1) {
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+      dYnorm2 > 0.0, "The transport table streams must differ");
+  }
+  amrex::Gpu::copy(
+    amrex::Gpu::hostToDevice, h_streams.begin(), h_streams.end(),
+    m_data.begin());
+
+  m_view.Y0 = m_data.data();
+  m_view.dY = m_data.data() + NUM_SPECIES;
+  m_view.table = m_data.data() + 2 * NUM_SPECIES;
+  m_view.nT = nT;
+  m_view.nZ = nZ;
+  m_view.Tmin = Tmin;
+  m_view.dTinv = (nT - 1) / (Tmax - Tmin);
+  m_view.dYnorm2inv = (nZ > 1) ? 1.0 / dYnorm2 : 0.0;
+
+  const TransportTableData view = m_view;
+  auto* table = m_data.data() + 2 * NUM_SPECIES;
+  amrex::ParallelFor(npts, [=] AMREX_GPU_DEVICE(amrex::Long n) noexcept {
+    const int iZ = static_cast<int>(n / nT);
+    const int iT = static_cast<int>(n % nT);
+    const amrex::Real T = view.Tmin + iT / view.dTinv;
+    const amrex::Real Z = (nZ > 1) ? static_cast<amrex::Real>(iZ) / (nZ - 1)
+                                   : 0.0;
+    amrex::Real Y[NUM_SPECIES];
+    for (int sp = 0; sp < NUM_SPECIES; ++sp) {
+      Y[sp] = view.Y0[sp] + Z * view.dY[sp];
+    }
+    auto eos = pele::physics::PhysicsType::eos();
+    amrex::Real rho = 0.0;
+    eos.PYT2R(p, Y, T, rho);
+
+    amrex::Real Ddiag[NUM_SPECIES];
+    amrex::Real mu = 0.0, xi = 0.0, lam = 0.0;
+    auto trans = pele::physics::PhysicsType::transport();
+    trans.transport(
+      true, true, true, true, false, T, rho, Y, Ddiag, nullptr, mu, xi, lam,
+      tparm);
+
+    amrex::Real* entry = table + n * ncomp;
+    for (int sp = 0; sp < NUM_SPECIES; ++sp) {
+      entry[dComp_rhoD + sp] = Ddiag[sp];
+    }
+    entry[dComp_mu] = mu;
+    entry[dComp_xi] = xi;
+    entry[dComp_lambda] = lam;
+  });
+  amrex::Gpu::streamSynchronize();
+}
+
+amrex::Real
+TransportTable::verify(TransParmType const* tparm) const
+{
+  const TransportTableData view = m_view;
+  const int nT = view.nT;
+  const int nZ = view.nZ;
+  const int nZmid = (nZ > 1) ? nZ - 1 : 1;
+  const auto npts = static_cast<amrex::Long>(nT - 1) * nZmid;
+  const amrex::Real p = m_p;
+
+  amrex::ReduceOps<amrex::ReduceOpMax> reduce_op;
+  amrex::ReduceData<amrex::Real> reduce_data(reduce_op);
+  using ReduceTuple = typename decltype(reduce_data)::Type;
+  reduce_op.eval(
+    npts, reduce_data,
+    [=] AMREX_GPU_DEVICE(amrex::Long n) noexcept -> ReduceTuple {
+      const int iZ = static_cast<int>(n / (nT - 1));
+      const int iT = static_cast<int>(n % (nT - 1));
+      const amrex::Real T = view.Tmin + (iT + 0.5) / view.dTinv;
+      const amrex::Real Z =
+        (nZ > 1) ? (iZ + 0.5) / static_cast<amrex::Real>(nZ - 1) : 0.0;
+      amrex::Real Y[NUM_SPECIES];
+      for (int sp = 0; sp < NUM_SPECIES; ++sp) {
+        Y[sp] = view.Y0[sp] + Z * view.dY[sp];
+      }
+      auto eos = pele::physics::PhysicsType::eos();
+      amrex::Real rho = 0.0;
+      eos.PYT2R(p, Y, T, rho);
+
+      amrex::Real Ddiag[NUM_SPECIES], Ddiag_tab[NUM_SPECIES];
+      amrex::Real mu = 0.0, xi = 0.0, lam = 0.0;
+      amrex::Real mu_tab = 0.0, xi_tab = 0.0, lam_tab = 0.0;
+      auto trans = pele::physics::PhysicsType::transport();
+      trans.transport(
+        true, true, true, true, false, T, rho, Y, Ddiag, nullptr, mu, xi, lam,
+        tparm);
+      view.lookup(
+        true, true, true, true, T, Y, Ddiag_tab, mu_tab, xi_tab, lam_tab);
+
+      auto relerr = [](const amrex::Real a, const amrex::Real b) {
+        return amrex::Math::abs(a - b) /
+               amrex::max<amrex::Real>(
+                 amrex::Math::abs(b), std::numeric_limits<amrex::Real>::min());
+      };
+      amrex::Real err = amrex::max(
+        relerr(mu_tab, mu), relerr(lam_tab, lam),
+        (xi == 0.0) ? 0.0 : relerr(xi_tab, xi));
+      for (int sp = 0; sp < NUM_SPECIES; ++sp) {
+        err = amrex::max(err, relerr(Ddiag_tab[sp], Ddiag[sp]));
+      }
+      return {err};
+    });
+  return amrex::get<0>(reduce_data.value(reduce_op));
+}
@@ -150,3 +150,56 @@ clean_massfrac(
       }
     });
 }
+
+void
+fused_state_update(
+  amrex::MultiFab& dst,
+  const amrex::Vector<std::pair<amrex::Real, const amrex::MultiFab*>>& terms,
+  const amrex::Real r,
+  const amrex::MultiFab* I_R,
+  const int ng)
+{
+  BL_PROFILE("fused_state_update()");
+
+  // Terms beyond the first max_fused_terms are accumulated by further
+  // passes, which only happens with many active sources
+  const int nterms =
+    amrex::min(static_cast<int>(terms.size()), max_fused_terms);
+  amrex::GpuArray<amrex::MultiArray4<const amrex::Real>, max_fused_terms>
+    tarrs;
+  amrex::GpuArray<amrex::Real, max_fused_terms> coefs = {{0.0}};
+  for (int t = 0; t < nterms; ++t) {
+    AMREX_ASSERT(terms[t].second->nGrow() >= ng);
+    tarrs[t] = terms[t].second->const_arrays();
+    coefs[t] = terms[t].first;
+  }
+  const bool add_react = (I_R != nullptr) && (r != 0.0);
+  const auto irarrs =
+    add_react ? I_R->const_arrays() : amrex::MultiArray4<const amrex::Real>();
+  const auto& darrs = dst.arrays();
+
+  amrex::ParallelFor(
+    dst, amrex::IntVect(ng), NVAR,
+    [=] AMREX_GPU_DEVICE(int nbx, int i, int j, int k, int n) noexcept {
+      amrex::Real val = 0.0;
+      for (int t = 0; t < nterms; ++t) {
+        val += coefs[t] * tarrs[t][nbx](i, j, k, n);
+      }
+      if (add_react) {
+        if ((n >= UFS) && (n < UFS + NUM_SPECIES)) {
+          val += r * irarrs[nbx](i, j, k, n - UFS);
+        } else if (n == UEDEN) {
+          val += r * irarrs[nbx](i, j, k, NUM_SPECIES);
+        }
+      }
+      darrs[nbx](i, j, k, n) = val;
+    });
+  amrex::Gpu::streamSynchronize();
+
+  if (terms.size() > max_fused_terms) {
+    amrex::Vector<std::pair<amrex::Real, const amrex::MultiFab*>> rest(
+      1, {1.0, &dst});
+    rest.insert(rest.end(), terms.begin() + max_fused_terms, terms.end());
+    fused_state_update(dst, rest, 0.0, nullptr, ng);
+  }
+}
@@ -158,6 +158,8 @@ main(int argc, char* argv[])
     (wall_time_elapsed < (max_wall_time * 3600.0) || max_wall_time < 0.0)) {
     // Do a timestep
     amrptr->coarseTimeStep(stop_time);
+    amrptr->finalizeCheckPoint(false);
+    amrptr->finalizePlotFiles(false);
 #ifdef AMREX_USE_ASCENT
     amrptr->doInSituViz(amrptr->levelSteps(0));
 #endif
@@ -170,11 +172,13 @@ main(int argc, char* argv[])
   if (amrptr->stepOfLastCheckPoint() < amrptr->levelSteps(0)) {
     amrptr->checkPoint();
   }
+  amrptr->finalizeCheckPoint(true);
 
   // Write final plotfile
   if (amrptr->stepOfLastPlotFile() < amrptr->levelSteps(0)) {
     amrptr->writePlotFile();
   }
+  amrptr->finalizePlotFiles(true);
 
   time(&time_type);
   gmtime_r(&time_type, &time_now);